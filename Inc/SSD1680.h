@@ -16,6 +16,7 @@
 #define SSD1680_SOURCE_VOLTAGE 0x04
 #define SSD1680_BOOSTER_SOFT_START 0x0C
 #define SSD1680_GATE_SCAN_START 0x0F
+#define SSD1680_DEEP_SLEEP 0x10
 #define SSD1680_DATA_ENTRY_MODE 0x11
 #define SSD1680_SW_RESET 0x12
 #define SSD1680_SELECT_TEMP_SENSOR 0x18
@@ -29,6 +30,8 @@
 #define SSD1680_READ 0x27
 #define SSD1680_VCOM_VOLTAGE 0x2C
 #define SSD1680_READ_USER_ID 0x2E
+#define SSD1680_WRITE_LUT 0x32
+#define SSD1680_END_OPTION 0x3F
 #define SSD1680_BORDER 0x3C
 #define SSD1680_RAM_READ_OPT 0x41
 #define SSD1680_RAM_X_RANGE 0x44
@@ -39,6 +42,101 @@
 #define SSD1680_RAM_Y 0x4F
 #define SSD1680_NOP 0x7F
 
+#define SSD1680_ERROR_NONE 0x00			/**< No error */
+#define SSD1680_ERROR_BUSY_TIMEOUT 0x01	/**< BUSY line didn't go low in time. Display is stuck. */
+
+#ifndef SSD1680_TIMEOUT_FULL_REFRESH
+#define SSD1680_TIMEOUT_FULL_REFRESH 20000	/**< Longest full refresh in ms */
+#endif // SSD1680_TIMEOUT_FULL_REFRESH
+#ifndef SSD1680_TIMEOUT_PARTIAL_REFRESH
+#define SSD1680_TIMEOUT_PARTIAL_REFRESH 5000	/**< Longest partial refresh in ms */
+#endif // SSD1680_TIMEOUT_PARTIAL_REFRESH
+#ifndef SSD1680_TIMEOUT_LOAD
+#define SSD1680_TIMEOUT_LOAD 500			/**< Longest update sequence without display stage (temperature or LUT load) in ms */
+#endif // SSD1680_TIMEOUT_LOAD
+#ifndef SSD1680_TIMEOUT_FILL
+#define SSD1680_TIMEOUT_FILL 200			/**< Longest RAM pattern fill in ms */
+#endif // SSD1680_TIMEOUT_FILL
+#ifndef SSD1680_TIMEOUT_RESET
+#define SSD1680_TIMEOUT_RESET 100			/**< Longest software reset in ms */
+#endif // SSD1680_TIMEOUT_RESET
+
+#define SSD1680_LUT_SIZE 153			/**< Size of waveform LUT in bytes */
+
+#ifndef SSD1680_GHOST_TILE_ROWS
+#define SSD1680_GHOST_TILE_ROWS 16		/**< Number of rows in a tile of ghosting heatmap */
+#endif // SSD1680_GHOST_TILE_ROWS
+#ifndef SSD1680_GHOST_TILES
+#define SSD1680_GHOST_TILES 19			/**< Number of tiles in ghosting heatmap. Rows beyond are accounted to the last tile. */
+#endif // SSD1680_GHOST_TILES
+
+#ifndef SSD1680_ENERGY_SLOTS
+#define SSD1680_ENERGY_SLOTS 24			/**< Number of slots of energy accounting window */
+#endif // SSD1680_ENERGY_SLOTS
+
+#ifndef SSD1680_MODEL_HEIGHTS
+#define SSD1680_MODEL_HEIGHTS 4			/**< Number of band height buckets of refresh duration model */
+#endif // SSD1680_MODEL_HEIGHTS
+#ifndef SSD1680_MODEL_TEMPS
+#define SSD1680_MODEL_TEMPS 4			/**< Number of temperature buckets of refresh duration model */
+#endif // SSD1680_MODEL_TEMPS
+#ifndef SSD1680_MODEL_TEMP_MIN
+#define SSD1680_MODEL_TEMP_MIN 0		/**< Upper bound of the lowest temperature bucket in °C */
+#endif // SSD1680_MODEL_TEMP_MIN
+#ifndef SSD1680_MODEL_TEMP_STEP
+#define SSD1680_MODEL_TEMP_STEP 10		/**< Width of temperature bucket in °C */
+#endif // SSD1680_MODEL_TEMP_STEP
+#ifndef SSD1680_MODEL_TEMP_PERIOD
+#define SSD1680_MODEL_TEMP_PERIOD 60000	/**< Time in ms refresh duration model keeps using the last known temperature after it was lost to reset */
+#endif // SSD1680_MODEL_TEMP_PERIOD
+#ifndef SSD1680_MODEL_TEMP_DEFAULT
+#define SSD1680_MODEL_TEMP_DEFAULT 25	/**< Temperature in °C refresh duration model assumes when it is neither sensed nor supplied */
+#endif // SSD1680_MODEL_TEMP_DEFAULT
+#ifndef SSD1680_MODEL_SHIFT
+#define SSD1680_MODEL_SHIFT 3			/**< EWMA smoothing factor of refresh duration model as power of 2 */
+#endif // SSD1680_MODEL_SHIFT
+
+#ifndef SSD1680_DIFF_CHUNK
+#define SSD1680_DIFF_CHUNK 64			/**< Size of buffer for copying previous image in bytes. Must fit a row. */
+#endif // SSD1680_DIFF_CHUNK
+
+#ifndef SSD1680_FLUSH_OVERHEAD
+#define SSD1680_FLUSH_OVERHEAD 24		/**< Cost of starting rectangle upload in bytes of payload. 14 bytes of commands and arguments sent under one CS assertion plus DC and call overhead. */
+#endif // SSD1680_FLUSH_OVERHEAD
+
+#ifndef SSD1680_PLAN_BOXES
+#define SSD1680_PLAN_BOXES 16			/**< Most rectangles planned at once */
+#endif // SSD1680_PLAN_BOXES
+
+#ifndef SSD1680_FRAME_FULL
+#define SSD1680_FRAME_FULL 50			/**< Percentage of changed bytes making SSD1680_ShowFrame use full refresh */
+#endif // SSD1680_FRAME_FULL
+
+#ifndef SSD1680_FRAME_BAND
+#define SSD1680_FRAME_BAND 64			/**< Tallest band of changed rows SSD1680_ShowFrame updates with region limited partial refresh */
+#endif // SSD1680_FRAME_BAND
+
+#ifndef SSD1680_FB_RECTS
+#define SSD1680_FB_RECTS SSD1680_PLAN_BOXES	/**< Most dirty rectangles tracked by framebuffer plane. Must not exceed @ref SSD1680_PLAN_BOXES. */
+#endif // SSD1680_FB_RECTS
+
+/**
+ * @def SSD1680_FB_SIZE
+ * Size of framebuffer storage in bytes for resolution and color depth
+ */
+#define SSD1680_FB_SIZE(x, y, depth) ((x) / 8 * (y) * (depth))
+
+#ifndef SSD1680_TRANSACTION_DEPTH
+#define SSD1680_TRANSACTION_DEPTH 10	/**< Maximum number of commands in a transaction */
+#endif // SSD1680_TRANSACTION_DEPTH
+#ifndef SSD1680_TRANSACTION_COPY
+#define SSD1680_TRANSACTION_COPY 4		/**< Arguments up to this size are copied into the transaction */
+#endif // SSD1680_TRANSACTION_COPY
+#ifndef SSD1680_TRANSACTION_ARGS
+#define SSD1680_TRANSACTION_ARGS 24		/**< Size of transaction storage for copied arguments */
+#endif // SSD1680_TRANSACTION_ARGS
+#define SSD1680_CHAIN_SIZE 12			/**< Size of storage for command bytes sent by DMA ahead of secondary (red) RAM bank data */
+
 /**
  * @enum SSD1680_Color
  * @brief Defines color
@@ -119,17 +217,290 @@ enum SSD1680_DataEntryMode {
  * @brief Display refresh mode
  */
 enum SSD1680_RefreshMode {
+  AutoRefresh = 0x00,		/**< Pick the cheapest mode keeping ghosting within budget. @see SSD1680_HandleTypeDef::Ghost_Budget */
   FullRefresh = 0xF7,		/**< Refresh whole screen in a slow robust flickery way */
   PartialRefresh = 0xFF,	/**< Refresh updated region in a slow robust flickery way */
   FastFullRefresh = 0xC7,	/**< Refresh whole screen in a fast way */
   FastPartialRefresh = 0xCF	/**< Refresh updated region in a fast way */
 };
 
+/**
+ * @enum SSD1680_DrawOp
+ * @brief Display list operation
+ * @see SSD1680_RenderList
+ */
+enum SSD1680_DrawOp {
+  DrawFill = 0,		/**< Filled rectangle */
+  DrawLine,			/**< Line */
+  DrawBitmap,		/**< Byte aligned image */
+  DrawText			/**< Text with transparent background */
+};
+
+/**
+ * @enum SSD1680_SleepMode
+ * @brief Deep sleep mode
+ * @details The display wakes up on hardware reset only.
+ * @see SSD1680_Sleep
+ */
+enum SSD1680_SleepMode {
+  DeepSleep1 = 0x01,	/**< Deep sleep mode 1. RAM content is retained. */
+  DeepSleep2 = 0x03		/**< Deep sleep mode 2. RAM content is lost. */
+};
+
+/**
+ * @enum SSD1680_State
+ * @brief Driver state
+ * @see SSD1680_GetState
+ */
+enum SSD1680_State {
+  StateReady = 0,   /**< No asynchronous operation in progress */
+  StateTransmit,    /**< DMA write to RAM in progress */
+  StateReceive,     /**< DMA read from RAM in progress */
+  StateBusy         /**< Display is busy (BUSY line is high) */
+};
+
+#if defined(SSD1680_STATS)
+/**
+ * @struct SSD1680_StatsTypeDef
+ * Bus activity counters
+ * @details Available when built with `SSD1680_STATS` defined. Reset by zeroing.
+ */
+typedef struct {
+  uint32_t Commands;		/**< Number of commands sent */
+  uint32_t SPI_Calls;		/**< Number of SPI transfers */
+  uint32_t SPI_Bytes;		/**< Number of bytes transferred over SPI */
+  uint32_t Pin_Toggles;		/**< Number of CS and !DC line writes */
+  uint32_t Commands_Skipped;	/**< Number of commands elided by the shadow register cache */
+  uint32_t Wait_Time;		/**< Time spent in SSD1680_Wait in ms */
+} SSD1680_StatsTypeDef;
+#endif // SSD1680_STATS
+
+/**
+ * @struct SSD1680_SchedulerStatsTypeDef
+ * Refresh scheduler statistics
+ * @see SSD1680_GetSchedulerStats
+ */
+typedef struct {
+  uint32_t Requests;		/**< Number of requested refreshes */
+  uint32_t Refreshes;		/**< Number of actually started refreshes */
+  uint32_t Urgent;			/**< Number of refreshes started by urgent request */
+  uint32_t Deadline_Hits;	/**< Number of refreshes started by deadline while requests kept coming */
+  uint32_t Rows;			/**< Total number of refreshed rows */
+} SSD1680_SchedulerStatsTypeDef;
+
+/**
+ * @struct SSD1680_EnergyModelTypeDef
+ * Energy cost of refresh
+ * @details Refresh costs fixed amount plus per row amount of its mode times number of scanned rows.
+ * Driving secondary (red) color adds per row amount too. Units are up to the application.
+ * @see SSD1680_HandleTypeDef::Energy_Model
+ */
+typedef struct {
+  uint32_t Fixed;			/**< Energy of any refresh */
+  uint16_t Full;			/**< Energy per row of @ref FullRefresh */
+  uint16_t Partial;			/**< Energy per row of @ref PartialRefresh */
+  uint16_t Fast_Full;		/**< Energy per row of @ref FastFullRefresh */
+  uint16_t Fast_Partial;	/**< Energy per row of @ref FastPartialRefresh */
+  uint16_t Red;				/**< Extra energy per row of driving secondary (red) color */
+} SSD1680_EnergyModelTypeDef;
+
+/**
+ * @struct SSD1680_EnergyLedgerTypeDef
+ * Energy spent in rolling accounting window
+ * @details Zero initialized by the application.
+ * @see SSD1680_HandleTypeDef::Energy_Ledger
+ */
+typedef struct {
+  uint32_t Used[SSD1680_ENERGY_SLOTS];	/**< Energy spent in every slot of accounting window */
+  uint32_t Start;			/**< Start of the current slot in ms */
+  uint8_t Slot;				/**< Current slot */
+} SSD1680_EnergyLedgerTypeDef;
+
+/**
+ * @struct SSD1680_GovernorStatsTypeDef
+ * Energy governor decisions
+ * @see SSD1680_GetGovernorStats
+ */
+typedef struct {
+  uint32_t Allowed;			/**< Number of refreshes fitting the budget as requested */
+  uint32_t Red_Skipped;		/**< Number of refreshes with secondary (red) color skipped */
+  uint32_t Downgraded;		/**< Number of refreshes downgraded to @ref FastPartialRefresh */
+  uint32_t Deferred;		/**< Number of refresh attempts deferred until budget allows */
+  uint32_t Overdrawn;		/**< Number of urgent refreshes started beyond the budget */
+} SSD1680_GovernorStatsTypeDef;
+
+/**
+ * @struct SSD1680_ShadowTypeDef
+ * Shadow copy of controller registers
+ * @details Writes of values already in effect are skipped.
+ * @see SSD1680_InvalidateShadow
+ */
+typedef struct {
+  uint32_t Valid;				/**< Bitmask of registers with known value */
+  uint8_t RAM_X_Range[2];		/**< RAM X address range (0x44) */
+  uint8_t RAM_Y_Range[4];		/**< RAM Y address range (0x45) */
+  uint8_t Data_Entry_Mode;		/**< Data entry mode (0x11) */
+  uint8_t RAM_Read_Option;		/**< RAM read option (0x41) */
+  uint8_t Border;				/**< Border waveform (0x3C) */
+  uint8_t Update_Control_1[2];	/**< Display update control 1 (0x21) */
+  uint8_t Booster[4];			/**< Booster soft start (0x0C) */
+  uint8_t Gate_Scan[3];			/**< Driver output control (0x01) */
+  uint8_t Gate_Scan_Start[2];	/**< Gate scan start position (0x0F) */
+  uint8_t Update_Control_2;		/**< Display update control 2 (0x22) */
+  uint8_t End_Option;			/**< End option (0x3F) */
+  uint8_t Gate_Voltage;			/**< Gate driving voltage (0x03) */
+  uint8_t Source_Voltage[3];	/**< Source driving voltage (0x04) */
+  uint8_t VCOM_Voltage;			/**< VCOM voltage (0x2C) */
+} SSD1680_ShadowTypeDef;
+
+/**
+ * @struct SSD1680_BoxTypeDef
+ * Rectangular screen region
+ * @details Right and bottom edges are exclusive. Region is empty if either dimension is not positive.
+ */
+typedef struct {
+  uint8_t Left;					/**< Leftmost column */
+  uint8_t Right;				/**< Column next to the rightmost one */
+  uint16_t Top;					/**< Topmost row */
+  uint16_t Bottom;				/**< Row next to the bottommost one */
+} SSD1680_BoxTypeDef;
+
+/**
+ * @struct SSD1680_LUTProfileTypeDef
+ * Custom waveform LUT along with driving voltages
+ * @details Profiles are picked by temperature for partial refresh.
+ * @see SSD1680_WriteLUT
+ * @see https://v4.cecdn.yun300.cn/100001_1909185147/SSD1680.pdf page 32
+ */
+typedef struct {
+  const char *Name;				/**< Profile name */
+  int8_t Temp_Min;				/**< Lowest temperature of the band in °C */
+  int8_t Temp_Max;				/**< Highest temperature of the band in °C */
+  uint8_t LUT[SSD1680_LUT_SIZE];	/**< Waveform LUT (0x32) */
+  uint8_t End_Option;			/**< End option (0x3F) */
+  uint8_t Gate_Voltage;			/**< Gate driving voltage (0x03) */
+  uint8_t Source_Voltage[3];	/**< Source driving voltage VSH1, VSH2, VSL (0x04) */
+  uint8_t VCOM_Voltage;			/**< VCOM voltage (0x2C) */
+} SSD1680_LUTProfileTypeDef;
+
+/**
+ * @struct SSD1680_FramebufferTypeDef
+ * Shadow framebuffer with dirty tracking
+ * @details Primary (black) plane is followed by secondary (red) one for 2 bit color depth.
+ * Rows are `Resolution_X / 8` bytes long, MSB is the leftmost pixel. Pixel colors are the same as in display RAM.
+ * Every plane keeps a short list of dirty byte aligned rectangles and the band of rows they cover.
+ * Marking a change touches a single rectangle of the list, whatever its height.
+ * @see SSD1680_Flush
+ */
+typedef struct {
+  uint8_t *Data;				/**< Plane storage of @ref SSD1680_FB_SIZE bytes */
+  SSD1680_BoxTypeDef Dirty[2][SSD1680_FB_RECTS];	/**< Dirty rectangles by plane */
+  uint8_t Dirty_Count[2];		/**< Number of dirty rectangles by plane */
+  uint16_t Dirty_Top[2];		/**< Topmost dirty row by plane */
+  uint16_t Dirty_Bottom[2];		/**< Row next to the bottommost dirty one by plane. No rows are dirty if not below the topmost one. */
+} SSD1680_FramebufferTypeDef;
+
+/**
+ * @struct SSD1680_DrawItemTypeDef
+ * Display list item
+ * @see SSD1680_DisplayListTypeDef
+ */
+typedef struct {
+  uint8_t Op;					/**< Operation. @see SSD1680_DrawOp */
+  uint8_t Color;				/**< Color of fill, line or text. @see SSD1680_Color */
+  uint8_t X0;					/**< Leftmost column or line start column */
+  uint8_t X1;					/**< Column next to the rightmost one or line end column */
+  uint16_t Y0;					/**< Topmost row or line start row */
+  uint16_t Y1;					/**< Row next to the bottommost one or line end row */
+  const void *Data;				/**< Bitmap for primary (black) plane or zero-terminated string */
+  const void *Aux;				/**< Bitmap for secondary (red) plane or font */
+} SSD1680_DrawItemTypeDef;
+
+/**
+ * @struct SSD1680_DisplayListTypeDef
+ * Recorded drawing operations
+ * @details Rendered band by band so that only a few rows of the image are ever kept in memory.
+ * Bitmaps, strings and fonts are referenced, not copied. They must stay valid until the list is rendered.
+ * @see SSD1680_RenderList
+ */
+typedef struct {
+  SSD1680_DrawItemTypeDef *Items;	/**< Item storage */
+  uint8_t Capacity;				/**< Number of items the storage fits */
+  uint8_t Count;				/**< Number of recorded items */
+} SSD1680_DisplayListTypeDef;
+
+/**
+ * @def SSD1680_FINGERPRINT_MAGIC
+ * Marks valid @ref SSD1680_FingerprintTypeDef
+ */
+#define SSD1680_FINGERPRINT_MAGIC 0x53443136
+
+/**
+ * @struct SSD1680_FingerprintTypeDef
+ * Fingerprint of displayed frame
+ * @details Kept by the application in memory surviving MCU reset, e.g. backup registers or `.noinit` section.
+ * @see SSD1680_FrameUnchanged
+ */
+typedef struct {
+  uint32_t Magic;				/**< @ref SSD1680_FINGERPRINT_MAGIC if the fingerprint is valid */
+  uint32_t Hash;				/**< FNV-1a hash of RAM writes making the frame */
+  uint8_t Mode;					/**< Refresh mode the frame was displayed with */
+} SSD1680_FingerprintTypeDef;
+
+/**
+ * @struct SSD1680_GhostMapTypeDef
+ * Ghosting heatmap
+ * @details Zero initialized by the application.
+ * @see SSD1680_HandleTypeDef::Ghost
+ */
+typedef struct {
+  uint8_t Level[SSD1680_GHOST_TILES];	/**< Ghosting level of every tile of rows since its last full refresh */
+} SSD1680_GhostMapTypeDef;
+
+/**
+ * @struct SSD1680_RefreshModelTypeDef
+ * Refresh duration model
+ * @details Zero initialized by the application.
+ * @see SSD1680_PredictRefresh
+ */
+typedef struct {
+  uint16_t Duration[4][SSD1680_MODEL_HEIGHTS][SSD1680_MODEL_TEMPS];	/**< Refresh duration EWMA in ms by mode, band height and temperature. 0 if unknown. */
+} SSD1680_RefreshModelTypeDef;
+
+/**
+ * @def SSD1680_INIT_WAIT
+ * Initialization step flag to wait for BUSY line to become low after the command
+ */
+#define SSD1680_INIT_WAIT 0x01
+
+/**
+ * @struct SSD1680_InitStepTypeDef
+ * Single command of initialization sequence
+ */
+typedef struct {
+  uint8_t Command;				/**< Command byte */
+  uint8_t Size;					/**< Size of command arguments */
+  uint8_t Flags;				/**< Step flags. @see SSD1680_INIT_WAIT */
+  uint8_t Args[4];				/**< Command arguments */
+} SSD1680_InitStepTypeDef;
+
+/**
+ * @struct SSD1680_InitProfileTypeDef
+ * Panel specific initialization sequence
+ * @details Sent right after hardware reset. Gate scan range, update control and data entry mode are set by SSD1680_Init afterwards.
+ * @see SSD1680_DefaultInit
+ */
+typedef struct {
+  const char *Name;				/**< Profile name */
+  const SSD1680_InitStepTypeDef *Steps;	/**< Initialization steps */
+  uint8_t Step_Count;			/**< Number of initialization steps */
+} SSD1680_InitProfileTypeDef;
+
 /**
  * @struct SSD1680_HandleTypeDef
  * SSD1680 handle
  */
-typedef struct {
+typedef struct __SSD1680_HandleTypeDef {
   SPI_HandleTypeDef *SPI_Handle;	/**< SPI handle */
   uint32_t SPI_Timeout;				/**< SPI timeout in ms */
   GPIO_TypeDef *CS_Port;			/**< CS signal GPIO port */
@@ -144,7 +515,96 @@ typedef struct {
   enum SSD1680_ScanMode Scan_Mode;	/**< Source scan mode. Smaller displays like 152x152 uses narrow scan. @see https://v4.cecdn.yun300.cn/100001_1909185147/SSD1680.pdf page 25. */
   uint8_t Resolution_X;				/**< Horizontal resolution. Must be a multiple of 8. */
   uint16_t Resolution_Y;			/**< Vertical resolution */
+  uint8_t BUSY_EXTI;				/**< Non-zero if BUSY falling edge EXTI calls SSD1680_BUSY_EXTI_Callback */
+  uint8_t Lazy_Wait;				/**< Non-zero to return from slow operations without waiting. The next command waits instead. */
+  uint32_t Busy_Timeout;			/**< Busy period timeout in ms. Set to 0 to derive from operation. @see SSD1680_Wait */
+  uint8_t Red_Bypass;				/**< Non-zero to bypass secondary (red) color channel on refresh if its RAM bank is unchanged. Only for 2 bit color depth. */
+  uint32_t Temp_Interval;			/**< Interval of internal temperature sensing in ms. Temperature and LUT are cached in between. Set to 0 to load them on every refresh. */
+  uint8_t Temp_Delta;				/**< Temperature drift in °C tolerated before LUT is reloaded. @see SSD1680_SetTemp */
+  const SSD1680_LUTProfileTypeDef *LUT_Profiles;	/**< Custom LUT profiles for partial refresh. Safe to set to NULL. */
+  uint8_t LUT_Profile_Count;		/**< Number of custom LUT profiles */
+  uint32_t Burst_Idle;				/**< Quiet period in ms before analog is disabled after burst partial refresh. Set to 0 to disable it after every refresh. @see SSD1680_Process */
+  uint8_t Differential;				/**< Non-zero to keep previous image in secondary (red) RAM bank for differential refresh. Only for 1 bit color depth. */
+  uint32_t Debounce;				/**< Quiet period in ms before requested refresh is started. @see SSD1680_RequestRefresh */
+  uint32_t Deadline;				/**< Longest delay of requested refresh in ms. Set to 0 for no limit. */
+  SSD1680_GhostMapTypeDef *Ghost;	/**< Ghosting heatmap. Safe to set to NULL, @ref AutoRefresh then always picks full refresh and nothing is cleaned. */
+  uint8_t Ghost_Budget;				/**< Ghosting level tolerated by @ref AutoRefresh. Fast partial refresh adds 2, partial one adds 1, full one clears. */
+  uint8_t Ghost_Clean;				/**< Ghosting level of a tile to be cleaned by full refresh in idle time. Set to 0 to disable. */
+  uint32_t Clean_Idle;				/**< Quiet period in ms before cleaning. @see SSD1680_Process */
+  const SSD1680_EnergyModelTypeDef *Energy_Model;	/**< Energy cost of refresh. Safe to set to NULL to disable energy governor. */
+  SSD1680_EnergyLedgerTypeDef *Energy_Ledger;	/**< Energy spent in accounting window. Safe to set to NULL to disable energy governor. */
+  uint32_t Energy_Budget;			/**< Energy allowed per accounting window */
+  uint32_t Energy_Window;			/**< Energy accounting window in ms */
+  const SSD1680_InitProfileTypeDef *Init_Profile;	/**< Initialization sequence. Set to NULL to use @ref SSD1680_DefaultInit. */
+  uint16_t Flush_Overhead;			/**< Cost of starting rectangle upload in bytes of payload. Set to 0 for @ref SSD1680_FLUSH_OVERHEAD. Setup time is fixed so it grows with SPI clock. @see SSD1680_PlanRegions */
+  SSD1680_FramebufferTypeDef *Framebuffer;	/**< Shadow framebuffer. Safe to set to NULL. @see SSD1680_Flush */
+  uint8_t Frame_Full;				/**< Percentage of changed bytes making @ref SSD1680_ShowFrame use full refresh. Set to 0 for @ref SSD1680_FRAME_FULL. */
+  uint16_t Frame_Band;				/**< Tallest band of changed rows @ref SSD1680_ShowFrame updates with region limited partial refresh. Taller ones use fast partial refresh. Set to 0 for @ref SSD1680_FRAME_BAND. */
+  SSD1680_FingerprintTypeDef *Fingerprint;	/**< Persistent fingerprint of displayed frame. Safe to set to NULL. @see SSD1680_FrameUnchanged */
+  SSD1680_RefreshModelTypeDef *Refresh_Model;	/**< Refresh duration model. Safe to set to NULL, refresh duration is unknown then. @see SSD1680_PredictRefresh */
+  uint8_t Auto_Recover;				/**< Non-zero to reset and reinitialize the display when it's stuck. @see SSD1680_Recover */
+  volatile uint32_t ErrorCode;		/**< Error flags. @see SSD1680_ERROR_BUSY_TIMEOUT */
+  uint32_t Busy_Duration;			/**< Duration of the last completed busy period in ms, i.e. refresh time */
+  uint32_t Resume_Duration;			/**< Duration of the last SSD1680_Resume in ms */
+  uint32_t Boot_Duration;			/**< Time from the last hardware reset to the first RAM write in ms */
+  void (*Transfer_Callback)(struct __SSD1680_HandleTypeDef *hepd, HAL_StatusTypeDef status);	/**< Called on DMA transfer completion. Safe to set to NULL. @see SSD1680_SetRegion_DMA */
+  void (*Ready_Callback)(struct __SSD1680_HandleTypeDef *hepd);	/**< Called when display becomes ready after busy period. Safe to set to NULL. @see SSD1680_Refresh_IT */
   /** @internal */
+  volatile enum SSD1680_State State;	/**< Driver state */
+  uint8_t *DMA_Data;				/**< Secondary (red) RAM bank data pending for DMA transfer */
+  uint16_t DMA_Size;				/**< Size of pending DMA transfer */
+  uint8_t DMA_Left;					/**< Leftmost column of pending DMA transfer */
+  uint16_t DMA_Top;					/**< Topmost row of pending DMA transfer */
+  HAL_StatusTypeDef DMA_Status;		/**< Status of failed DMA transfer not yet reported. Cleared when the next transfer starts. */
+  uint8_t DMA_Chain[SSD1680_CHAIN_SIZE];	/**< Commands sent by DMA ahead of secondary (red) RAM bank data. Each is command byte, arguments size and arguments. */
+  uint8_t DMA_Chain_Size;			/**< Used size of DMA_Chain or 0 if no command is being sent by DMA */
+  uint8_t DMA_Chain_Pos;			/**< Offset of the command being sent in DMA_Chain */
+  uint8_t DMA_Chain_Phase;			/**< Progress of the command being sent: 0 before command byte, 1 before arguments, 2 when sent */
+  SSD1680_ShadowTypeDef Shadow;		/**< Shadow copy of controller registers */
+  uint32_t Busy_Start;				/**< Start of busy period in ms */
+  uint32_t Busy_Limit;				/**< Timeout of busy period in ms */
+  uint8_t Recovering;				/**< Non-zero while SSD1680_Recover is in progress */
+  int8_t Temp;						/**< Last known temperature in °C */
+  uint32_t Temp_Time;				/**< Time of the last temperature sensing or supply in ms */
+  uint8_t Temp_Known;				/**< Non-zero if temperature was sensed or supplied since reset */
+  uint8_t Temp_External;			/**< Non-zero if temperature is supplied with SSD1680_SetTemp */
+  int8_t LUT_Temp;					/**< Temperature in °C the loaded OTP LUT is for */
+  uint8_t LUT_Valid;				/**< Non-zero if the loaded OTP LUT matches cached temperature */
+  const SSD1680_LUTProfileTypeDef *LUT_Profile;	/**< Uploaded custom LUT profile or NULL if OTP LUT is loaded */
+  uint8_t Analog_On;				/**< Non-zero if clock and analog are left running by burst refresh */
+  uint8_t Gate_Limited;				/**< Non-zero if gate scan range is left limited by refresh of a band of rows */
+  SSD1680_BoxTypeDef Diff_Box;		/**< Region of primary (black) RAM bank changed since displayed */
+  uint8_t Diff_Direct;				/**< Non-zero if Diff_Box was written around the framebuffer */
+  SSD1680_BoxTypeDef Copy_Box;		/**< Displayed region pending copy into secondary (red) RAM bank */
+  uint8_t Copy_Pending;				/**< Non-zero if Copy_Box is to be copied */
+  uint8_t Sched_Pending;			/**< Non-zero if refresh is requested */
+  uint8_t Sched_Urgent;				/**< Non-zero if requested refresh is urgent */
+  uint8_t Sched_Mode;				/**< Merged mode of requested refresh */
+  uint16_t Sched_Top;				/**< Topmost row of requested refresh */
+  uint16_t Sched_Bottom;			/**< Row next to the bottommost one of requested refresh */
+  uint32_t Sched_First;				/**< Time of the first pending request in ms */
+  uint32_t Sched_Last;				/**< Time of the last pending request in ms */
+  SSD1680_SchedulerStatsTypeDef Sched_Stats;	/**< Refresh scheduler statistics */
+  SSD1680_GovernorStatsTypeDef Governor_Stats;	/**< Energy governor decisions */
+  uint16_t *Model_Pending;			/**< Model bucket of refresh in progress */
+  int8_t Model_Temp;				/**< Last known temperature for refresh duration model in °C */
+  uint32_t Model_Temp_Time;			/**< Time temperature was last known in ms */
+  uint8_t Model_Temp_Valid;			/**< Non-zero if Model_Temp holds a sensed or supplied temperature */
+  uint32_t Busy_Expected;			/**< Predicted duration of busy period in ms. 0 if unknown. */
+  uint8_t Framebuffer_Lost;			/**< Non-zero if display RAM doesn't match the framebuffer anymore */
+  uint32_t Frame_Hash;				/**< FNV-1a hash of RAM writes since @ref SSD1680_FrameBegin or the last full screen refresh */
+  uint8_t Frame_Dry;				/**< Non-zero if RAM writes are only hashed */
+  uint8_t Fingerprint_Pending;		/**< Non-zero if fingerprint is to be validated when refresh completes */
+  uint32_t Boot_Start;				/**< Time of the last hardware reset in ms */
+  uint8_t Boot_Pending;				/**< Non-zero until the first RAM write after hardware reset */
+  uint8_t Sleep;					/**< Deep sleep mode the display is in or 0 if awake */
+  uint32_t Sleep_Valid;				/**< Shadow registers known before deep sleep, restored by SSD1680_Resume */
+  uint8_t LUT_Lost;					/**< Non-zero if no LUT is loaded */
+  uint8_t Inverse;					/**< Bit mask of RAM banks inverted on refresh. @see SSD1680_Invert */
+  uint8_t Red_Dirty;				/**< Non-zero if secondary (red) RAM bank was written since the last refresh */
+#if defined(SSD1680_STATS)
+  SSD1680_StatsTypeDef Stats;		/**< Bus activity counters */
+#endif // SSD1680_STATS
 #if defined(DEBUG)
   GPIO_TypeDef *LED_Port;			/**< Activity LED GPIO port. Safe to set to NULL. */
   uint16_t LED_Pin;					/**< Activity LED pin number */
@@ -152,16 +612,86 @@ typedef struct {
   /** @endinternal */
 } SSD1680_HandleTypeDef;
 
+/**
+ * @struct SSD1680_TransactionTypeDef
+ * Sequence of commands to be sent under a single CS assertion
+ * @see SSD1680_TransactionBegin
+ */
+typedef struct {
+  SSD1680_HandleTypeDef *hepd;		/**< SSD1680 handle */
+  struct {
+    const uint8_t *pData;			/**< Command arguments */
+    uint16_t size;					/**< Size of command arguments */
+    uint8_t command;				/**< Command byte */
+  } commands[SSD1680_TRANSACTION_DEPTH];	/**< Accumulated commands */
+  uint8_t count;					/**< Number of accumulated commands */
+  uint8_t argsSize;					/**< Used size of argument storage */
+  uint8_t args[SSD1680_TRANSACTION_ARGS];	/**< Storage for copied arguments */
+} SSD1680_TransactionTypeDef;
+
+extern const SSD1680_InitProfileTypeDef SSD1680_DefaultInit;
+
 // Connectivity
 void SSD1680_Reset(SSD1680_HandleTypeDef *hepd);
-void SSD1680_Init(SSD1680_HandleTypeDef *hepd);
+HAL_StatusTypeDef SSD1680_Init(SSD1680_HandleTypeDef *hepd);
+HAL_StatusTypeDef SSD1680_Recover(SSD1680_HandleTypeDef *hepd);
+HAL_StatusTypeDef SSD1680_Sleep(SSD1680_HandleTypeDef *hepd, const enum SSD1680_SleepMode mode);
+HAL_StatusTypeDef SSD1680_Resume(SSD1680_HandleTypeDef *hepd);
+void SSD1680_InvalidateShadow(SSD1680_HandleTypeDef *hepd);
+HAL_StatusTypeDef SSD1680_Send(SSD1680_HandleTypeDef *hepd, const uint8_t command, const uint8_t *pData, const size_t size);
+HAL_StatusTypeDef SSD1680_Receive(SSD1680_HandleTypeDef *hepd, const uint8_t command, uint8_t *pData, const size_t size);
+void SSD1680_TransactionBegin(SSD1680_HandleTypeDef *hepd, SSD1680_TransactionTypeDef *tx);
+HAL_StatusTypeDef SSD1680_TransactionAdd(SSD1680_TransactionTypeDef *tx, const uint8_t command, const uint8_t *pData, const uint16_t size);
+HAL_StatusTypeDef SSD1680_TransactionCommit(SSD1680_TransactionTypeDef *tx);
 // High level functions
 HAL_StatusTypeDef SSD1680_Clear(SSD1680_HandleTypeDef *hepd, const enum SSD1680_Color color);
 HAL_StatusTypeDef SSD1680_Refresh(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode);
+HAL_StatusTypeDef SSD1680_Refresh_IT(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode);
+HAL_StatusTypeDef SSD1680_RefreshRegion(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode);
+HAL_StatusTypeDef SSD1680_RefreshRegion_IT(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode);
+HAL_StatusTypeDef SSD1680_RequestRefresh(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode, const uint8_t urgent);
+HAL_StatusTypeDef SSD1680_Wait(SSD1680_HandleTypeDef *hepd);
+void SSD1680_FrameBegin(SSD1680_HandleTypeDef *hepd, const uint8_t dryRun);
+uint8_t SSD1680_FrameUnchanged(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode);
+HAL_StatusTypeDef SSD1680_PowerDown(SSD1680_HandleTypeDef *hepd);
 HAL_StatusTypeDef SSD1680_Border(SSD1680_HandleTypeDef *hepd, const enum SSD1680_Color color);
+uint16_t SSD1680_ReadTemp(SSD1680_HandleTypeDef *hepd);
+void SSD1680_SetTemp(SSD1680_HandleTypeDef *hepd, const int8_t temp);
+HAL_StatusTypeDef SSD1680_WriteLUT(SSD1680_HandleTypeDef *hepd, const SSD1680_LUTProfileTypeDef *profile);
+HAL_StatusTypeDef SSD1680_Invert(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RAMBank bank, const uint8_t enable);
 HAL_StatusTypeDef SSD1680_GetRegion(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, uint8_t *data_k, uint8_t *data_r);
 HAL_StatusTypeDef SSD1680_SetRegion(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r);
+uint8_t SSD1680_PlanRegions(SSD1680_HandleTypeDef *hepd, SSD1680_BoxTypeDef *boxes, const uint8_t count);
+HAL_StatusTypeDef SSD1680_SetRegions(SSD1680_HandleTypeDef *hepd, const SSD1680_BoxTypeDef *boxes, const uint8_t count, const uint8_t *image_k, const uint8_t *image_r);
 HAL_StatusTypeDef SSD1680_Text(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const char *string, const SSD1680_FontTypeDef *font);
 HAL_StatusTypeDef SSD1680_VerticalText(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const char *string, const SSD1680_FontTypeDef *font);
 HAL_StatusTypeDef SSD1680_Checker(SSD1680_HandleTypeDef *hepd);
+// Framebuffer
+HAL_StatusTypeDef SSD1680_DrawPixel(SSD1680_HandleTypeDef *hepd, const uint8_t x, const uint16_t y, const enum SSD1680_Color color);
+HAL_StatusTypeDef SSD1680_DrawRect(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const enum SSD1680_Color color);
+HAL_StatusTypeDef SSD1680_DrawRegion(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r);
+HAL_StatusTypeDef SSD1680_DrawFrame(SSD1680_HandleTypeDef *hepd, const uint8_t *image_k, const uint8_t *image_r, uint32_t *changed);
+HAL_StatusTypeDef SSD1680_Flush(SSD1680_HandleTypeDef *hepd, uint16_t *top, uint16_t *height);
+HAL_StatusTypeDef SSD1680_ShowFrame(SSD1680_HandleTypeDef *hepd, const uint8_t *image_k, const uint8_t *image_r);
+// Display list
+void SSD1680_ListClear(SSD1680_DisplayListTypeDef *list);
+HAL_StatusTypeDef SSD1680_ListFill(SSD1680_DisplayListTypeDef *list, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const enum SSD1680_Color color);
+HAL_StatusTypeDef SSD1680_ListLine(SSD1680_DisplayListTypeDef *list, const uint8_t x0, const uint16_t y0, const uint8_t x1, const uint16_t y1, const enum SSD1680_Color color);
+HAL_StatusTypeDef SSD1680_ListBitmap(SSD1680_DisplayListTypeDef *list, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r);
+HAL_StatusTypeDef SSD1680_ListText(SSD1680_DisplayListTypeDef *list, const uint8_t left, const uint16_t top, const char *string, const SSD1680_FontTypeDef *font, const enum SSD1680_Color color);
+HAL_StatusTypeDef SSD1680_RenderList(SSD1680_HandleTypeDef *hepd, const SSD1680_DisplayListTypeDef *list, uint8_t *band, const uint16_t rows, const enum SSD1680_Color background);
+HAL_StatusTypeDef SSD1680_RenderList_DMA(SSD1680_HandleTypeDef *hepd, const SSD1680_DisplayListTypeDef *list, uint8_t *band0, uint8_t *band1, const uint16_t rows, const enum SSD1680_Color background);
+// Asynchronous functions
+HAL_StatusTypeDef SSD1680_GetRegion_DMA(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, uint8_t *data_k, uint8_t *data_r);
+HAL_StatusTypeDef SSD1680_SetRegion_DMA(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r);
+enum SSD1680_State SSD1680_GetState(SSD1680_HandleTypeDef *hepd);
+uint32_t SSD1680_PredictRefresh(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode);
+uint32_t SSD1680_ExpectedReady(SSD1680_HandleTypeDef *hepd);
+HAL_StatusTypeDef SSD1680_Process(SSD1680_HandleTypeDef *hepd);
+void SSD1680_GetSchedulerStats(SSD1680_HandleTypeDef *hepd, SSD1680_SchedulerStatsTypeDef *stats);
+uint32_t SSD1680_EnergyRemaining(SSD1680_HandleTypeDef *hepd);
+void SSD1680_GetGovernorStats(SSD1680_HandleTypeDef *hepd, SSD1680_GovernorStatsTypeDef *stats);
+void SSD1680_SPI_CpltCallback(SSD1680_HandleTypeDef *hepd, SPI_HandleTypeDef *hspi);
+void SSD1680_SPI_ErrorCallback(SSD1680_HandleTypeDef *hepd, SPI_HandleTypeDef *hspi);
+void SSD1680_BUSY_EXTI_Callback(SSD1680_HandleTypeDef *hepd, uint16_t GPIO_Pin);
 #endif // INC_SSD1680_H_
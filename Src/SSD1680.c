@@ -6,29 +6,591 @@
  */
 
 #include "../Inc/SSD1680.h"
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef SSD1680_DUMMY_BYTES
+#define SSD1680_DUMMY_BYTES 2
+#endif // SSD1680_DUMMY_BYTES
+#if SSD1680_DUMMY_BYTES > SSD1680_CHAIN_SIZE
+#error "SSD1680_DUMMY_BYTES must fit into SSD1680_CHAIN_SIZE"
+#endif // SSD1680_DUMMY_BYTES
+#if SSD1680_FB_RECTS > SSD1680_PLAN_BOXES
+#error "SSD1680_FB_RECTS must not exceed SSD1680_PLAN_BOXES"
+#endif // SSD1680_FB_RECTS
+
+#define SSD1680_LOAD_TEMP 0x20	/**< Update control 2 bit to load temperature value */
+#define SSD1680_LOAD_LUT 0x10	/**< Update control 2 bit to load LUT for temperature value */
+#define SSD1680_DISPLAY_MODE_2 0x08	/**< Update control 2 bit to display with mode 2 (partial) */
+#define SSD1680_POWER_ON 0xC0	/**< Update control 2 bits to enable clock and analog */
+#define SSD1680_POWER_OFF 0x03	/**< Update control 2 bits to disable analog and clock */
+
+#define SSD1680_GOVERN_RED 0x01		/**< Energy governor skipped secondary (red) color */
+#define SSD1680_GOVERN_DOWNGRADE 0x02	/**< Energy governor downgraded refresh to fast partial one */
+#define SSD1680_GOVERN_OVERDRAW 0x04	/**< Energy governor let urgent refresh overdraw the budget */
+
+#define SSD1680_FNV_BASIS 2166136261UL	/**< FNV-1a 32 bit offset basis */
+#define SSD1680_FNV_PRIME 16777619UL	/**< FNV-1a 32 bit prime */
+
+#if defined(SSD1680_STATS)
+#define SSD1680_STAT(hepd, counter, n) ((hepd)->Stats.counter += (n))
+#else
+#define SSD1680_STAT(hepd, counter, n) ((void)0)
+#endif // SSD1680_STATS
+
+/**
+ * @brief Forget shadow copy of controller registers
+ * @details Makes the next write of every cached register to be actually sent.
+ * Called internally on reset. Call it after talking to the controller bypassing the driver.
+ * @param[in] hepd: SSD1680 handle pointer
+ */
+void SSD1680_InvalidateShadow(SSD1680_HandleTypeDef *hepd) {
+  hepd->Shadow.Valid = 0;
+}
+
+/**
+ * @brief Registers having shadow copy
+ * @details Index in this table is the bit number in @ref SSD1680_ShadowTypeDef::Valid
+ */
+static const struct {
+  uint8_t command;
+  uint8_t offset;
+  uint8_t size;
+} SSD1680_ShadowMap[] = {
+  { SSD1680_RAM_X_RANGE, offsetof(SSD1680_ShadowTypeDef, RAM_X_Range), sizeof(((SSD1680_ShadowTypeDef *)0)->RAM_X_Range) },
+  { SSD1680_RAM_Y_RANGE, offsetof(SSD1680_ShadowTypeDef, RAM_Y_Range), sizeof(((SSD1680_ShadowTypeDef *)0)->RAM_Y_Range) },
+  { SSD1680_DATA_ENTRY_MODE, offsetof(SSD1680_ShadowTypeDef, Data_Entry_Mode), sizeof(((SSD1680_ShadowTypeDef *)0)->Data_Entry_Mode) },
+  { SSD1680_RAM_READ_OPT, offsetof(SSD1680_ShadowTypeDef, RAM_Read_Option), sizeof(((SSD1680_ShadowTypeDef *)0)->RAM_Read_Option) },
+  { SSD1680_BORDER, offsetof(SSD1680_ShadowTypeDef, Border), sizeof(((SSD1680_ShadowTypeDef *)0)->Border) },
+  { SSD1680_UPDATE_CONTROL_1, offsetof(SSD1680_ShadowTypeDef, Update_Control_1), sizeof(((SSD1680_ShadowTypeDef *)0)->Update_Control_1) },
+  { SSD1680_BOOSTER_SOFT_START, offsetof(SSD1680_ShadowTypeDef, Booster), sizeof(((SSD1680_ShadowTypeDef *)0)->Booster) },
+  { SSD1680_GATE_SCAN, offsetof(SSD1680_ShadowTypeDef, Gate_Scan), sizeof(((SSD1680_ShadowTypeDef *)0)->Gate_Scan) },
+  { SSD1680_GATE_SCAN_START, offsetof(SSD1680_ShadowTypeDef, Gate_Scan_Start), sizeof(((SSD1680_ShadowTypeDef *)0)->Gate_Scan_Start) },
+  { SSD1680_UPDATE_CONTROL_2, offsetof(SSD1680_ShadowTypeDef, Update_Control_2), sizeof(((SSD1680_ShadowTypeDef *)0)->Update_Control_2) },
+  { SSD1680_END_OPTION, offsetof(SSD1680_ShadowTypeDef, End_Option), sizeof(((SSD1680_ShadowTypeDef *)0)->End_Option) },
+  { SSD1680_GATE_VOLTAGE, offsetof(SSD1680_ShadowTypeDef, Gate_Voltage), sizeof(((SSD1680_ShadowTypeDef *)0)->Gate_Voltage) },
+  { SSD1680_SOURCE_VOLTAGE, offsetof(SSD1680_ShadowTypeDef, Source_Voltage), sizeof(((SSD1680_ShadowTypeDef *)0)->Source_Voltage) },
+  { SSD1680_VCOM_VOLTAGE, offsetof(SSD1680_ShadowTypeDef, VCOM_Voltage), sizeof(((SSD1680_ShadowTypeDef *)0)->VCOM_Voltage) },
+};
+
+/**
+ * @brief Find shadow copy of controller register
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] command: command byte
+ * @param[in] size: size of command arguments
+ * @param[out] bit: validity bit of the register
+ * @return Pointer to the shadow copy or NULL if the command has no shadow copy
+ */
+static uint8_t *SSD1680_ShadowLookup(SSD1680_HandleTypeDef *hepd, const uint8_t command, const size_t size, uint32_t *bit) {
+  for (uint8_t i = 0; i < sizeof(SSD1680_ShadowMap) / sizeof(SSD1680_ShadowMap[0]); ++i) {
+    if (SSD1680_ShadowMap[i].command != command)
+      continue;
+    if (SSD1680_ShadowMap[i].size != size)
+      return NULL;
+    *bit = 1UL << i;
+    return (uint8_t *)&hepd->Shadow + SSD1680_ShadowMap[i].offset;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Check command against shadow copy of controller registers
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] command: command byte
+ * @param[in] pData: pointer to the command arguments
+ * @param[in] size: size of command arguments
+ * @return Non-zero if register already holds the value and the command can be skipped
+ */
+static uint8_t SSD1680_ShadowHit(SSD1680_HandleTypeDef *hepd, const uint8_t command, const uint8_t *pData, const size_t size) {
+  uint32_t bit;
+  const uint8_t *reg = SSD1680_ShadowLookup(hepd, command, size, &bit);
+  if (!reg || !(hepd->Shadow.Valid & bit) || memcmp(reg, pData, size))
+    return 0;
+  SSD1680_STAT(hepd, Commands_Skipped, 1);
+  return 1;
+}
+
+/**
+ * @brief Update shadow copy of controller registers after command is sent
+ * @details @ref SSD1680_SW_RESET invalidates the whole shadow copy.
+ * Writes to secondary (red) RAM bank are tracked to decide if secondary color channel can be bypassed on refresh.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] command: command byte
+ * @param[in] pData: pointer to the command arguments
+ * @param[in] size: size of command arguments
+ */
+static void SSD1680_ShadowUpdate(SSD1680_HandleTypeDef *hepd, const uint8_t command, const uint8_t *pData, const size_t size) {
+  uint32_t bit;
+  uint8_t *reg = SSD1680_ShadowLookup(hepd, command, size, &bit);
+  if (reg) {
+    memcpy(reg, pData, size);
+    hepd->Shadow.Valid |= bit;
+  } else if (command == SSD1680_SW_RESET) {
+    SSD1680_InvalidateShadow(hepd);
+  } else if (command == SSD1680_WRITE_RED || command == SSD1680_PATTERN_RED) {
+    hepd->Red_Dirty = 1;
+  }
+  if (hepd->Boot_Pending && (command == SSD1680_WRITE_BLACK || command == SSD1680_WRITE_RED || command == SSD1680_PATTERN_BLACK || command == SSD1680_PATTERN_RED)) {
+    hepd->Boot_Duration = HAL_GetTick() - hepd->Boot_Start;
+    hepd->Boot_Pending = 0;
+  }
+}
+
+/**
+ * @brief Finish busy period
+ * @details Records busy period duration, returns driver into ready state and notifies the caller via @ref SSD1680_HandleTypeDef::Ready_Callback
+ * @param[in] hepd: SSD1680 handle pointer
+ */
+static void SSD1680_BusyDone(SSD1680_HandleTypeDef *hepd) {
+  hepd->Busy_Duration = HAL_GetTick() - hepd->Busy_Start;
+  if (hepd->Model_Pending) {
+    uint16_t *estimate = hepd->Model_Pending;
+    const int32_t sample = hepd->Busy_Duration < 0xFFFF ? hepd->Busy_Duration : 0xFFFF;
+    hepd->Model_Pending = NULL;
+    if (*estimate)
+      *estimate += (sample - *estimate) / (1 << SSD1680_MODEL_SHIFT);
+    else
+      *estimate = sample;
+    if (!*estimate)
+      *estimate = 1;
+  }
+  if (hepd->Fingerprint_Pending) {
+    hepd->Fingerprint_Pending = 0;
+    hepd->Fingerprint->Magic = SSD1680_FINGERPRINT_MAGIC;
+  }
+  hepd->State = StateReady;
+  if (hepd->Ready_Callback)
+    hepd->Ready_Callback(hepd);
+}
+
+/**
+ * @brief Get the longest expected busy period after the command
+ * @details Derived from the command and, for @ref SSD1680_MASTER_ACTIVATION, from the update sequence in effect.
+ * Overridden by @ref SSD1680_HandleTypeDef::Busy_Timeout if set.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] command: command making the display busy
+ * @return Timeout in ms
+ */
+static uint32_t SSD1680_BusyTimeout(SSD1680_HandleTypeDef *hepd, const uint8_t command) {
+  if (hepd->Busy_Timeout)
+    return hepd->Busy_Timeout;
+  switch (command) {
+  case SSD1680_SW_RESET:
+    return SSD1680_TIMEOUT_RESET;
+  case SSD1680_PATTERN_BLACK:
+  case SSD1680_PATTERN_RED:
+    return SSD1680_TIMEOUT_FILL;
+  case SSD1680_MASTER_ACTIVATION:
+    {
+      uint32_t bit;
+      const uint8_t *sequence = SSD1680_ShadowLookup(hepd, SSD1680_UPDATE_CONTROL_2, 1, &bit);
+      if (!sequence || !(hepd->Shadow.Valid & bit))
+        return SSD1680_TIMEOUT_FULL_REFRESH;
+      if (!(*sequence & 0x04))  // no display stage
+        return SSD1680_TIMEOUT_LOAD;
+      return (*sequence & 0x08) ? SSD1680_TIMEOUT_PARTIAL_REFRESH : SSD1680_TIMEOUT_FULL_REFRESH;
+    }
+  default:
+    return SSD1680_TIMEOUT_FULL_REFRESH;
+  }
+}
+
+/**
+ * @brief Start busy period
+ * @details Called right after the command making the display busy.
+ * BUSY line is checked after the state is set so that falling edge can't be missed.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] command: command making the display busy
+ */
+static void SSD1680_BusyStart(SSD1680_HandleTypeDef *hepd, const uint8_t command) {
+  hepd->Busy_Start = HAL_GetTick();
+  hepd->Busy_Limit = SSD1680_BusyTimeout(hepd, command);
+  hepd->Busy_Expected = 0;
+  hepd->State = StateBusy;
+  if (HAL_GPIO_ReadPin(hepd->BUSY_Port, hepd->BUSY_Pin) == GPIO_PIN_RESET)
+    SSD1680_BusyDone(hepd);
+}
+
 /**
  * @brief Hardware reset the display
- * @details Ties !RESET line to GND for 2 ms
+ * @details Ties !RESET line to GND for 2 ms.
+ * The display is kept busy until BUSY line becomes low rather than for a fixed time so the next command waits only as long as needed.
  * @param[in] hepd: SSD1680 handle pointer
  */
 void SSD1680_Reset(SSD1680_HandleTypeDef *hepd) {
+  SSD1680_InvalidateShadow(hepd);
+  hepd->Red_Dirty = 1;
+  hepd->LUT_Valid = 0;
+  hepd->LUT_Profile = NULL;
+  hepd->LUT_Lost = 1;
+  if (!hepd->Temp_External)
+    hepd->Temp_Known = 0;
+  hepd->Analog_On = 0;
+  hepd->Gate_Limited = 0;
+  hepd->Copy_Pending = 0;
+  hepd->Diff_Box = (SSD1680_BoxTypeDef){ 0, hepd->Resolution_X, 0, hepd->Resolution_Y };
+  hepd->Diff_Direct = 1;
+  hepd->Framebuffer_Lost = 1;
+  hepd->Frame_Hash = SSD1680_FNV_BASIS;
+  hepd->Frame_Dry = 0;
+  hepd->Fingerprint_Pending = 0;
+  if (hepd->State == StateBusy)
+    hepd->State = StateReady;
   HAL_GPIO_WritePin(hepd->RESET_Port, hepd->RESET_Pin, GPIO_PIN_RESET);
   HAL_Delay(2);
   HAL_GPIO_WritePin(hepd->RESET_Port, hepd->RESET_Pin, GPIO_PIN_SET);
-  HAL_Delay(10);
+  hepd->Boot_Start = HAL_GetTick();
+  hepd->Boot_Pending = 1;
+  HAL_Delay(1);
+  SSD1680_BusyStart(hepd, SSD1680_SW_RESET);
+}
+
+/**
+ * @brief Restore controller registers from shadow copy
+ * @details Update control sequence 2 is not restored as it is always sent along with master activation.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] shadow: shadow copy taken before reset
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_Replay(SSD1680_HandleTypeDef *hepd, const SSD1680_ShadowTypeDef *shadow) {
+  HAL_StatusTypeDef status = HAL_OK;
+  for (uint8_t i = 0; i < sizeof(SSD1680_ShadowMap) / sizeof(SSD1680_ShadowMap[0]) && !status; ++i) {
+    if (!(shadow->Valid & (1UL << i)) || SSD1680_ShadowMap[i].command == SSD1680_UPDATE_CONTROL_2)
+      continue;
+    status = SSD1680_Send(hepd, SSD1680_ShadowMap[i].command, (const uint8_t *)shadow + SSD1680_ShadowMap[i].offset, SSD1680_ShadowMap[i].size);
+  }
+  return status;
+}
+
+/**
+ * @brief Recover stuck display
+ * @details Hardware resets and reinitializes the display then restores
+ * RAM ranges, data entry mode, border, update control and gate scan range known before.
+ * RAM content is lost.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ */
+HAL_StatusTypeDef SSD1680_Recover(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (hepd->Recovering)
+    return HAL_ERROR;
+  hepd->Recovering = 1;
+  const SSD1680_ShadowTypeDef shadow = hepd->Shadow;
+  hepd->State = StateReady;
+  if (!(status = SSD1680_Init(hepd)))
+    status = SSD1680_Replay(hepd, &shadow);
+  hepd->Recovering = 0;
+  return status;
 }
 
 /**
  * @brief Wait for display ready
- * @details Waits for BUSY line to become low. Spins with 2ms delay while not yet.
+ * @details Waits for BUSY line to become low.
+ * If @ref SSD1680_HandleTypeDef::BUSY_EXTI is set sleeps with `__WFI` until SSD1680_BUSY_EXTI_Callback reports the falling edge.
+ * Otherwise sleeps with `__WFI` through most of the predicted duration (see SSD1680_PredictRefresh),
+ * then polls BUSY line on every wakeup, at least on every SysTick.
+ *
+ * Gives up when the busy period exceeds the timeout derived from the operation (see `SSD1680_TIMEOUT_*`)
+ * or @ref SSD1680_HandleTypeDef::Busy_Timeout.
+ * The display is then considered stuck: @ref SSD1680_ERROR_BUSY_TIMEOUT is set in @ref SSD1680_HandleTypeDef::ErrorCode
+ * and, if @ref SSD1680_HandleTypeDef::Auto_Recover is set, SSD1680_Recover is called.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ * @retval HAL_TIMEOUT if the display is stuck
+ * @retval HAL_ERROR if the display is stuck and SSD1680_Recover failed
+ */
+HAL_StatusTypeDef SSD1680_Wait(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+#if defined(SSD1680_STATS)
+  const uint32_t start = HAL_GetTick();
+#endif // SSD1680_STATS
+  if (hepd->State != StateBusy) {
+    // Called outside of known busy period
+    hepd->Busy_Start = HAL_GetTick();
+    hepd->Busy_Limit = SSD1680_BusyTimeout(hepd, SSD1680_NOP);
+  }
+  if (hepd->BUSY_EXTI && hepd->State == StateBusy) {
+    while (hepd->State == StateBusy && HAL_GetTick() - hepd->Busy_Start <= hepd->Busy_Limit)
+      __WFI();
+    if (hepd->State == StateBusy)
+      status = HAL_TIMEOUT;
+  } else {
+    // Sleep through most of predicted duration instead of polling
+    const uint32_t expected = hepd->Busy_Expected - hepd->Busy_Expected / 8;
+    if (hepd->State == StateBusy)
+      while (HAL_GetTick() - hepd->Busy_Start < expected)
+        __WFI();
+    while (HAL_GPIO_ReadPin(hepd->BUSY_Port, hepd->BUSY_Pin) == GPIO_PIN_SET) {
+      if (HAL_GetTick() - hepd->Busy_Start > hepd->Busy_Limit) {
+        status = HAL_TIMEOUT;
+        break;
+      }
+      __WFI();
+    }
+    if (!status && hepd->State == StateBusy)
+      SSD1680_BusyDone(hepd);
+  }
+#if defined(SSD1680_STATS)
+  hepd->Stats.Wait_Time += HAL_GetTick() - start;
+#endif // SSD1680_STATS
+  if (status) {
+    hepd->State = StateReady;
+    hepd->ErrorCode |= SSD1680_ERROR_BUSY_TIMEOUT;
+    if (hepd->Auto_Recover && SSD1680_Recover(hepd))
+      status = HAL_ERROR;
+  }
+  return status;
+}
+
+/**
+ * @brief Wait for display ready unless lazy waiting is enabled
+ * @details With @ref SSD1680_HandleTypeDef::Lazy_Wait set the wait is deferred
+ * until the next command is about to be sent.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_Settle(SSD1680_HandleTypeDef *hepd) {
+  return hepd->Lazy_Wait ? HAL_OK : SSD1680_Wait(hepd);
+}
+
+/**
+ * @brief Extend the box of primary (black) RAM bank changes not yet displayed
+ * @details The change is taken as made around the framebuffer, @ref SSD1680_Flush tells its own writes apart.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] left: leftmost column. Must be a multiple of 8.
+ * @param[in] top: topmost row
+ * @param[in] width: width of changed region. Must be a multiple of 8.
+ * @param[in] height: height of changed region
+ * @see SSD1680_HandleTypeDef::Differential
+ */
+static void SSD1680_MarkDirty(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height) {
+  SSD1680_BoxTypeDef *box = &hepd->Diff_Box;
+  hepd->Diff_Direct = 1;
+  if (box->Right <= box->Left || box->Bottom <= box->Top) {
+    box->Left = left;
+    box->Top = top;
+    box->Right = left + width;
+    box->Bottom = top + height;
+    return;
+  }
+  if (left < box->Left)
+    box->Left = left;
+  if (top < box->Top)
+    box->Top = top;
+  if (left + width > box->Right)
+    box->Right = left + width;
+  if (top + height > box->Bottom)
+    box->Bottom = top + height;
+}
+
+static HAL_StatusTypeDef SSD1680_CopyPrevious(SSD1680_HandleTypeDef *hepd);
+
+/**
+ * @brief Check if RAM writes are to be hashed
+ * @details Hash is only of use to compare with a fingerprint or while in dry run.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return Non-zero if RAM writes are hashed
+ */
+static inline uint8_t SSD1680_Hashing(SSD1680_HandleTypeDef *hepd) {
+  return hepd->Fingerprint || hepd->Frame_Dry;
+}
+
+/**
+ * @brief Add bytes to frame hash
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] pData: pointer to the bytes
+ * @param[in] size: number of bytes
+ */
+static void SSD1680_Hash(SSD1680_HandleTypeDef *hepd, const uint8_t *pData, const size_t size) {
+  uint32_t hash = hepd->Frame_Hash;
+  for (size_t i = 0; i < size; ++i)
+    hash = (hash ^ pData[i]) * SSD1680_FNV_PRIME;
+  hepd->Frame_Hash = hash;
+}
+
+/**
+ * @brief Add rows of a region to frame hash
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] data: first row
+ * @param[in] width: region width
+ * @param[in] height: region height
+ * @param[in] stride: distance between rows in bytes
+ */
+static void SSD1680_HashRows(SSD1680_HandleTypeDef *hepd, const uint8_t *data, const uint8_t width, const uint16_t height, const size_t stride) {
+  if (stride == width / 8u) {
+    SSD1680_Hash(hepd, data, stride * height);
+    return;
+  }
+  for (uint16_t y = 0; y < height; ++y)
+    SSD1680_Hash(hepd, data + y * stride, width / 8);
+}
+
+/**
+ * @brief Add region write to frame hash
+ * @details Position and size are hashed along with data so that the same data at another place makes another frame.
+ * Every write of region data hashes this way, so the hash doesn't depend on which call wrote the region.
+ * Does nothing unless hashing is needed. @see SSD1680_Hashing
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] left: leftmost column of the region
+ * @param[in] top: topmost row of the region
+ * @param[in] width: region width
+ * @param[in] height: region height
+ * @param[in] data_k: data for primary (black) RAM bank or NULL
+ * @param[in] data_r: data for secondary (red) RAM bank or NULL
+ * @param[in] stride: distance between rows of data in bytes, `width / 8` if rows are contiguous
+ */
+static void SSD1680_HashRegion(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r, const size_t stride) {
+  if (!SSD1680_Hashing(hepd))
+    return;
+  const uint8_t region[] = { left, top >> 8, top, width, height >> 8, height };
+  SSD1680_Hash(hepd, region, sizeof(region));
+  if (data_k) {
+    const uint8_t command = SSD1680_WRITE_BLACK;
+    SSD1680_Hash(hepd, &command, sizeof(command));
+    SSD1680_HashRows(hepd, data_k, width, height, stride);
+  }
+  if (data_r) {
+    const uint8_t command = SSD1680_WRITE_RED;
+    SSD1680_Hash(hepd, &command, sizeof(command));
+    SSD1680_HashRows(hepd, data_r, width, height, stride);
+  }
+}
+
+/**
+ * @brief BUSY line EXTI handler
+ * @details Finishes busy period on BUSY falling edge.
+ * Call it from `HAL_GPIO_EXTI_Callback` and set @ref SSD1680_HandleTypeDef::BUSY_EXTI.
+ * BUSY pin EXTI must be configured for falling edge.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] GPIO_Pin: pin the callback was called for. Ignored if doesn't match BUSY pin.
+ * @see SSD1680_Refresh_IT
+ */
+void SSD1680_BUSY_EXTI_Callback(SSD1680_HandleTypeDef *hepd, uint16_t GPIO_Pin) {
+  if (GPIO_Pin != hepd->BUSY_Pin || hepd->State != StateBusy)
+    return;
+  if (HAL_GPIO_ReadPin(hepd->BUSY_Port, hepd->BUSY_Pin) == GPIO_PIN_RESET)
+    SSD1680_BusyDone(hepd);
+}
+
+/**
+ * @brief Get ready for the next command
+ * @details Waits for the end of busy period if any.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ * @retval HAL_BUSY if asynchronous transfer is in progress
+ * @retval HAL_TIMEOUT if the display is stuck
+ * @retval HAL_ERROR if the display is in deep sleep
+ */
+static HAL_StatusTypeDef SSD1680_Acquire(SSD1680_HandleTypeDef *hepd) {
+  if (hepd->Sleep)
+    return HAL_ERROR;
+  if (hepd->State == StateBusy) {
+    HAL_StatusTypeDef status = HAL_OK;
+    if ((status = SSD1680_Wait(hepd)))
+      return status;
+  }
+  return hepd->State == StateReady ? HAL_OK : HAL_BUSY;
+}
+
+/**
+ * @brief Check if command makes the display busy
+ * @param[in] command: command byte
+ * @return Non-zero if BUSY line goes high after the command
+ */
+static inline uint8_t SSD1680_IsBusyCommand(const uint8_t command) {
+  return command == SSD1680_MASTER_ACTIVATION || command == SSD1680_SW_RESET
+      || command == SSD1680_PATTERN_BLACK || command == SSD1680_PATTERN_RED;
+}
+
+/**
+ * @brief Drive CS line
+ * @details Writes BSRR directly instead of calling HAL_GPIO_WritePin.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] state: line state
+ */
+static inline void SSD1680_CS(SSD1680_HandleTypeDef *hepd, const GPIO_PinState state) {
+  hepd->CS_Port->BSRR = state == GPIO_PIN_SET ? hepd->CS_Pin : (uint32_t)hepd->CS_Pin << 16;
+  SSD1680_STAT(hepd, Pin_Toggles, 1);
+}
+
+/**
+ * @brief Drive !DC line
+ * @details Writes BSRR directly instead of calling HAL_GPIO_WritePin.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] state: line state
+ */
+static inline void SSD1680_DC(SSD1680_HandleTypeDef *hepd, const GPIO_PinState state) {
+  hepd->DC_Port->BSRR = state == GPIO_PIN_SET ? hepd->DC_Pin : (uint32_t)hepd->DC_Pin << 16;
+  SSD1680_STAT(hepd, Pin_Toggles, 1);
+}
+
+/**
+ * @brief Drive activity LED
+ * @details Does nothing unless built with `DEBUG` defined.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] active: non-zero when SPI transfer is in progress
+ */
+static inline void SSD1680_Activity(SSD1680_HandleTypeDef *hepd, const uint8_t active) {
+#if defined(DEBUG)
+  if (hepd->LED_Port)
+    HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, active ? GPIO_PIN_RESET : GPIO_PIN_SET);
+#else
+  (void)hepd;
+  (void)active;
+#endif // DEBUG
+}
+
+/**
+ * @brief Transmit bytes over SPI
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] pData: pointer to data
+ * @param[in] size: size of data
+ * @return HAL status
+ */
+static inline HAL_StatusTypeDef SSD1680_SPI_Transmit(SSD1680_HandleTypeDef *hepd, const uint8_t *pData, const uint16_t size) {
+  SSD1680_STAT(hepd, SPI_Calls, 1);
+  SSD1680_STAT(hepd, SPI_Bytes, size);
+  return HAL_SPI_Transmit(hepd->SPI_Handle, (uint8_t *)pData, size, hepd->SPI_Timeout);
+}
+
+/**
+ * @brief Receive bytes over SPI
  * @param[in] hepd: SSD1680 handle pointer
+ * @param[out] pData: pointer to buffer
+ * @param[in] size: size of buffer
+ * @return HAL status
+ */
+static inline HAL_StatusTypeDef SSD1680_SPI_Receive(SSD1680_HandleTypeDef *hepd, uint8_t *pData, const uint16_t size) {
+  SSD1680_STAT(hepd, SPI_Calls, 1);
+  SSD1680_STAT(hepd, SPI_Bytes, size);
+  return HAL_SPI_Receive(hepd->SPI_Handle, pData, size, hepd->SPI_Timeout);
+}
+
+/**
+ * @brief Start SPI DMA transmission
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] pData: pointer to data
+ * @param[in] size: size of data
+ * @return HAL status
+ */
+static inline HAL_StatusTypeDef SSD1680_SPI_Transmit_DMA(SSD1680_HandleTypeDef *hepd, const uint8_t *pData, const uint16_t size) {
+  SSD1680_STAT(hepd, SPI_Calls, 1);
+  SSD1680_STAT(hepd, SPI_Bytes, size);
+  return HAL_SPI_Transmit_DMA(hepd->SPI_Handle, (uint8_t *)pData, size);
+}
+
+/**
+ * @brief Start SPI DMA reception
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[out] pData: pointer to buffer
+ * @param[in] size: size of buffer
+ * @return HAL status
  */
-void SSD1680_Wait(SSD1680_HandleTypeDef *hepd) {
-  while (HAL_GPIO_ReadPin(hepd->BUSY_Port, hepd->BUSY_Pin) == GPIO_PIN_SET)
-    HAL_Delay(2);
+static inline HAL_StatusTypeDef SSD1680_SPI_Receive_DMA(SSD1680_HandleTypeDef *hepd, uint8_t *pData, const uint16_t size) {
+  SSD1680_STAT(hepd, SPI_Calls, 1);
+  SSD1680_STAT(hepd, SPI_Bytes, size);
+  return HAL_SPI_Receive_DMA(hepd->SPI_Handle, pData, size);
 }
 
 /**
@@ -41,35 +603,34 @@ void SSD1680_Wait(SSD1680_HandleTypeDef *hepd) {
  * @param[in] pData: pointer to the command arguments
  * @param[in] size: size of command arguments
  * @return HAL status
+ * @retval HAL_BUSY if asynchronous transfer is in progress
+ * @note Waits for display ready if it is busy.
+ * @note Command is skipped if it writes the value the register already holds.
  * @see https://v4.cecdn.yun300.cn/100001_1909185147/SSD1680.pdf page 20 for full command list.
- *
+ * @see SSD1680_TransactionBegin to send several commands at once
  */
 HAL_StatusTypeDef SSD1680_Send(SSD1680_HandleTypeDef *hepd, const uint8_t command, const uint8_t *pData, const size_t size) {
   HAL_StatusTypeDef status = HAL_OK;
-#if defined(DEBUG)
-  if (hepd->LED_Port)
-    HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_RESET);
-#endif
-  HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_RESET);
-  HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_RESET);
-  if ((status = HAL_SPI_Transmit(hepd->SPI_Handle, (uint8_t *)&command, sizeof(command), hepd->SPI_Timeout))) {
-    HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_SET);
-#if defined(DEBUG)
-    if (hepd->LED_Port)
-      HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_SET);
-#endif
+  if ((status = SSD1680_Acquire(hepd)))
     return status;
-  }
-  HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_SET);
-  if (size > 0) {
-    status = HAL_SPI_Transmit(hepd->SPI_Handle, (uint8_t *)pData, size, hepd->SPI_Timeout);
-  }
-  HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_SET);
-#if defined(DEBUG)
-  if (hepd->LED_Port)
-    HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_SET);
-#endif
+  if (SSD1680_ShadowHit(hepd, command, pData, size))
+    return status;
+  SSD1680_STAT(hepd, Commands, 1);
+  SSD1680_Activity(hepd, 1);
+  SSD1680_CS(hepd, GPIO_PIN_RESET);
+  SSD1680_DC(hepd, GPIO_PIN_RESET);
+  status = SSD1680_SPI_Transmit(hepd, &command, sizeof(command));
+  SSD1680_DC(hepd, GPIO_PIN_SET);
+  if (!status && size > 0)
+    status = SSD1680_SPI_Transmit(hepd, pData, size);
+  SSD1680_CS(hepd, GPIO_PIN_SET);
+  SSD1680_Activity(hepd, 0);
+  if (status)
+    SSD1680_InvalidateShadow(hepd);
+  else
+    SSD1680_ShadowUpdate(hepd, command, pData, size);
+  if (!status && SSD1680_IsBusyCommand(command))
+    SSD1680_BusyStart(hepd, command);
   return status;
 }
 
@@ -83,40 +644,136 @@ HAL_StatusTypeDef SSD1680_Send(SSD1680_HandleTypeDef *hepd, const uint8_t comman
  * @param[in] pData: pointer to the buffer for return value
  * @param[in] size: size of the buffer in bytes
  * @return HAL status
+ * @retval HAL_BUSY if asynchronous transfer is in progress
  * @see https://v4.cecdn.yun300.cn/100001_1909185147/SSD1680.pdf page 20 for full command list.
  */
 HAL_StatusTypeDef SSD1680_Receive(SSD1680_HandleTypeDef *hepd, const uint8_t command, uint8_t *pData, const size_t size) {
   HAL_StatusTypeDef status = HAL_OK;
-#if defined(DEBUG)
-  if (hepd->LED_Port)
-    HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_RESET);
-#endif
-  HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_RESET);
-  HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_RESET);
-  if ((status = HAL_SPI_Transmit(hepd->SPI_Handle, (uint8_t *)&command, sizeof(command), hepd->SPI_Timeout))) {
-    HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_SET);
-#if defined(DEBUG)
-    if (hepd->LED_Port)
-      HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_SET);
-#endif
+  if ((status = SSD1680_Acquire(hepd)))
     return status;
+  SSD1680_STAT(hepd, Commands, 1);
+  SSD1680_Activity(hepd, 1);
+  SSD1680_CS(hepd, GPIO_PIN_RESET);
+  SSD1680_DC(hepd, GPIO_PIN_RESET);
+  status = SSD1680_SPI_Transmit(hepd, &command, sizeof(command));
+  SSD1680_DC(hepd, GPIO_PIN_SET);
+  if (!status && size > 0)
+    status = SSD1680_SPI_Receive(hepd, pData, size);
+  SSD1680_CS(hepd, GPIO_PIN_SET);
+  SSD1680_Activity(hepd, 0);
+  return status;
+}
+
+/**
+ * @brief Start a transaction
+ * @details Transaction accumulates a sequence of commands with their arguments
+ * to be sent under a single CS assertion with only !DC line toggling between them.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[out] tx: transaction to initialize
+ * @see SSD1680_TransactionAdd
+ * @see SSD1680_TransactionCommit
+ */
+void SSD1680_TransactionBegin(SSD1680_HandleTypeDef *hepd, SSD1680_TransactionTypeDef *tx) {
+  tx->hepd = hepd;
+  tx->count = 0;
+  tx->argsSize = 0;
+}
+
+/**
+ * @brief Append command to a transaction
+ * @details Arguments up to @ref SSD1680_TRANSACTION_COPY bytes long are copied into the transaction.
+ * Longer ones (i.e. RAM data) are referenced and must stay valid until the transaction is committed.
+ * @param[in] tx: transaction
+ * @param[in] command: command byte
+ * @param[in] pData: pointer to the command arguments
+ * @param[in] size: size of command arguments
+ * @return HAL status
+ * @retval HAL_ERROR if transaction is full
+ * @see SSD1680_TransactionBegin
+ */
+HAL_StatusTypeDef SSD1680_TransactionAdd(SSD1680_TransactionTypeDef *tx, const uint8_t command, const uint8_t *pData, const uint16_t size) {
+  if (tx->count >= SSD1680_TRANSACTION_DEPTH)
+    return HAL_ERROR;
+  if (size <= SSD1680_TRANSACTION_COPY && size <= sizeof(tx->args) - tx->argsSize) {
+    memcpy(tx->args + tx->argsSize, pData, size);
+    pData = tx->args + tx->argsSize;
+    tx->argsSize += size;
   }
-  HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_SET);
-  if (size > 0) {
-    status = HAL_SPI_Receive(hepd->SPI_Handle, pData, size, hepd->SPI_Timeout);
+  tx->commands[tx->count].command = command;
+  tx->commands[tx->count].pData = pData;
+  tx->commands[tx->count].size = size;
+  ++tx->count;
+  return HAL_OK;
+}
+
+/**
+ * @brief Send accumulated commands
+ * @details Not intended to be used outside of SSD1680_TransactionCommit and bulk transfer functions.
+ * @param[in] tx: transaction
+ * @param[in] keepSelected: leave CS line asserted after the last command so that more data can follow
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_TransactionSend(SSD1680_TransactionTypeDef *tx, const uint8_t keepSelected) {
+  SSD1680_HandleTypeDef *hepd = tx->hepd;
+  HAL_StatusTypeDef status = HAL_OK;
+  if ((status = SSD1680_Acquire(hepd)))
+    return status;
+  uint8_t selected = 0;
+  for (uint8_t i = 0; i < tx->count && !status; ++i) {
+    // Checked at send time so that values set earlier in the same transaction count
+    if (SSD1680_ShadowHit(hepd, tx->commands[i].command, tx->commands[i].pData, tx->commands[i].size))
+      continue;
+    if (!selected) {
+      SSD1680_Activity(hepd, 1);
+      SSD1680_CS(hepd, GPIO_PIN_RESET);
+      selected = 1;
+    }
+    SSD1680_STAT(hepd, Commands, 1);
+    SSD1680_DC(hepd, GPIO_PIN_RESET);
+    status = SSD1680_SPI_Transmit(hepd, &tx->commands[i].command, sizeof(tx->commands[i].command));
+    SSD1680_DC(hepd, GPIO_PIN_SET);
+    if (!status && tx->commands[i].size > 0)
+      status = SSD1680_SPI_Transmit(hepd, tx->commands[i].pData, tx->commands[i].size);
+    if (!status)
+      SSD1680_ShadowUpdate(hepd, tx->commands[i].command, tx->commands[i].pData, tx->commands[i].size);
+    if (!status && SSD1680_IsBusyCommand(tx->commands[i].command)) {
+      SSD1680_BusyStart(hepd, tx->commands[i].command);
+      if (i + 1 < tx->count)
+        status = SSD1680_Wait(hepd);
+    }
   }
-  HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_SET);
-#if defined(DEBUG)
-  if (hepd->LED_Port)
-    HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_SET);
-#endif
+  tx->count = 0;
+  tx->argsSize = 0;
+  if (!selected && keepSelected && !status) {
+    SSD1680_Activity(hepd, 1);
+    SSD1680_CS(hepd, GPIO_PIN_RESET);
+  } else if (selected && (status || !keepSelected)) {
+    SSD1680_CS(hepd, GPIO_PIN_SET);
+    SSD1680_Activity(hepd, 0);
+  }
+  if (status)
+    SSD1680_InvalidateShadow(hepd);
   return status;
 }
 
+/**
+ * @brief Send accumulated commands
+ * @details Sends all the commands of the transaction under a single CS assertion.
+ * Commands writing the value the register already holds by then are skipped.
+ * The transaction is emptied afterwards and can be reused.
+ * @param[in] tx: transaction
+ * @return HAL status
+ * @retval HAL_BUSY if asynchronous transfer is in progress
+ * @see SSD1680_TransactionBegin
+ */
+HAL_StatusTypeDef SSD1680_TransactionCommit(SSD1680_TransactionTypeDef *tx) {
+  return SSD1680_TransactionSend(tx, 0);
+}
+
 /**
  * @brief Get gate (row) scan range for refresh operation
- * @details Set the range of rows to be updated on next refresh
+ * @details Set the range of rows to be updated on next refresh.
+ * Driver output control takes the number of gate lines minus one.
  * @param[in] hepd: SSD1680 handle pointer
  * @param[in] top: topmost row to be updated
  * @param[in] height: number of rows to be updated
@@ -128,11 +785,25 @@ HAL_StatusTypeDef SSD1680_GateScanRange(SSD1680_HandleTypeDef *hepd, const uint1
     return status;
 #pragma pack(push, 1)
   const struct {
-    uint16_t height;
+    uint16_t mux;
     uint8_t order;
-  } gateScan = { height, 0 };
+  } gateScan = { height - 1, 0 };
 #pragma pack(pop)
-  return SSD1680_Send(hepd, SSD1680_GATE_SCAN, (uint8_t *)&gateScan, sizeof(gateScan));     // 0x01
+  if ((status = SSD1680_Send(hepd, SSD1680_GATE_SCAN, (uint8_t *)&gateScan, sizeof(gateScan))))     // 0x01
+    return status;
+  hepd->Gate_Limited = 0;
+  return status;
+}
+
+/**
+ * @brief Restore full screen gate scan range left limited by refresh of a band of rows
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_RestoreGateScan(SSD1680_HandleTypeDef *hepd) {
+  if (!hepd->Gate_Limited)
+    return HAL_OK;
+  return SSD1680_GateScanRange(hepd, 0, hepd->Resolution_Y);
 }
 
 /**
@@ -143,20 +814,21 @@ HAL_StatusTypeDef SSD1680_GateScanRange(SSD1680_HandleTypeDef *hepd, const uint1
  * @return HAL status
  */
 HAL_StatusTypeDef SSD1680_DataEntryMode(SSD1680_HandleTypeDef *hepd, const enum SSD1680_DataEntryMode mode) {
-  return SSD1680_Send(hepd, SSD1680_DATA_ENTRY_MODE, &mode, sizeof(mode));   // 0x11
+  const uint8_t dataEntryMode = mode;
+  return SSD1680_Send(hepd, SSD1680_DATA_ENTRY_MODE, &dataEntryMode, sizeof(dataEntryMode));   // 0x11
 }
 
 /**
- * @brief Send update control sequence 1.
- * @details Not intended to be used outside of SSD1680_Refresh
- * @param[in] hepd: SSD1680 handle pointer
+ * @brief Append update control sequence 1 to a transaction
+ * @details RAM banks are inverted according to @ref SSD1680_Invert
+ * @param[in] tx: transaction
+ * @param[in] bypassR: non-zero to treat secondary (red) RAM bank content as 0 during update
  * @return HAL status
- * @see SSD1680_Refresh
+ * @see SSD1680_UpdateControl
  */
-HAL_StatusTypeDef SSD1680_UpdateControl(SSD1680_HandleTypeDef *hepd) {
-  const uint8_t inverseR = 0;
-  const uint8_t bypassR = hepd->Color_Depth & 0x01;
-  const uint8_t inverseK = 0;
+static HAL_StatusTypeDef SSD1680_AddUpdateControl(SSD1680_TransactionTypeDef *tx, const uint8_t bypassR) {
+  const uint8_t inverseR = (tx->hepd->Inverse >> RAMRed) & 0x01;
+  const uint8_t inverseK = (tx->hepd->Inverse >> RAMBlack) & 0x01;
   const uint8_t bypassK = 0;
 #pragma pack(push, 1)
   const struct {
@@ -170,97 +842,195 @@ HAL_StatusTypeDef SSD1680_UpdateControl(SSD1680_HandleTypeDef *hepd) {
     // MSB
     uint8_t reserved0:7;
     uint8_t sourceMode:1;
-  } updateControl1 = { 0, bypassK, inverseK, 0, bypassR, inverseR, 0, hepd->Scan_Mode };
+  } updateControl1 = { 0, bypassK, inverseK, 0, bypassR, inverseR, 0, tx->hepd->Scan_Mode };
 #pragma pack(pop)
-  return SSD1680_Send(hepd, SSD1680_UPDATE_CONTROL_1, (uint8_t *)&updateControl1, sizeof(updateControl1));  // 0x21
+  return SSD1680_TransactionAdd(tx, SSD1680_UPDATE_CONTROL_1, (uint8_t *)&updateControl1, sizeof(updateControl1));  // 0x21
 }
 
 /**
- * @brief Initialize the display
- * @details
- * @li Reset the disply
- * @li Send initialization sequence
- * @li Set source and gate scan ranges to maximum resolution
- * @li Enable internal temperature sensor
- * @li Setup voltage sources
+ * @brief Send update control sequence 1.
+ * @details Not intended to be used outside of SSD1680_Init and SSD1680_Refresh
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ * @see SSD1680_Refresh
+ */
+HAL_StatusTypeDef SSD1680_UpdateControl(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_AddUpdateControl(&tx, hepd->Color_Depth & 0x01)))
+    return status;
+  return SSD1680_TransactionCommit(&tx);
+}
+
+/**
+ * @brief Default initialization sequence
+ * @details Software reset and fixed temperature of 100 °C.
+ * Temperature sensing and LUT loading are left to the first refresh.
+ * Gate, source and VCOM voltages are set along with custom LUT. See SSD1680_WriteLUT
+ */
+static const SSD1680_InitStepTypeDef SSD1680_DefaultInitSteps[] = {
+  { SSD1680_SW_RESET, 0, SSD1680_INIT_WAIT, { 0 } },
+  { SSD1680_WRITE_TEMP, 1, 0, { 0x64 } },
+};
+
+const SSD1680_InitProfileTypeDef SSD1680_DefaultInit = {
+  "SSD1680",
+  SSD1680_DefaultInitSteps,
+  sizeof(SSD1680_DefaultInitSteps) / sizeof(SSD1680_DefaultInitSteps[0])
+};
+
+/**
+ * @brief Initialize the display
+ * @details
+ * @li Reset the disply
+ * @li Send initialization sequence of @ref SSD1680_HandleTypeDef::Init_Profile
+ * @li Set source and gate scan ranges to maximum resolution
  * @li Set data entry mode to @ref RightThenDown
+ *
+ * No fixed delays are used. The display is polled for BUSY line only where the sequence asks to.
+ * LUT is loaded by the first refresh.
  * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
  */
-void SSD1680_Init(SSD1680_HandleTypeDef *hepd) {
-  HAL_GPIO_WritePin(hepd->RESET_Port, hepd->RESET_Pin, GPIO_PIN_RESET);
+HAL_StatusTypeDef SSD1680_Init(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  const SSD1680_InitProfileTypeDef *profile = hepd->Init_Profile ? hepd->Init_Profile : &SSD1680_DefaultInit;
   HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_SET);
   HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_SET);
-  HAL_Delay(2);
-  HAL_GPIO_WritePin(hepd->RESET_Port, hepd->RESET_Pin, GPIO_PIN_SET);
-  HAL_Delay(20);
-
-  /*
-   _START_SEQUENCE = (
-      b"\x12\x80\x14"  # soft reset and wait 20ms
-      b"\x11\x01\x03"  # Ram data entry mode
-      b"\x3C\x01\x05"  # border color
-      b"\x2c\x01\x36"  # Set vcom voltage
-      b"\x03\x01\x17"  # Set gate voltage
-      b"\x04\x03\x41\x00\x32"  # Set source voltage
-      b"\x4e\x01\x01"  # ram x count
-      b"\x4f\x02\x00\x00"  # ram y count
-      b"\x01\x03\x00\x00\x00"  # set display size
-      b"\x22\x01\xf4"  # display update mode
-  )
-  */
-
-  /***** #2 *****/
   SSD1680_Reset(hepd);
-  SSD1680_Send(hepd, SSD1680_SW_RESET, 0, 0);
-  SSD1680_Wait(hepd);
-
-  uint8_t userId[10] = { 0 };
-  SSD1680_Receive(hepd, SSD1680_READ_USER_ID, userId, sizeof(userId)); // 0x2E
 
-  /***** #3 *****/
-
-  //const uint8_t gateVoltage[] = { 0x00 };
-  //SSD1680_Send(&hepd, SSD1680_GATE_VOLTAGE, gateVoltage, sizeof(gateVoltage));  // 0x03
-  //const uint8_t sourceVoltage[] = { 0x41, 0x48, 0x32 };
-  //SSD1680_Send(&hepd, SSD1680_SOURCE_VOLTAGE, sourceVoltage, sizeof(sourceVoltage));  // 0x04
-  //const uint8_t vcomVoltage[] = { 0x38 };
-  //SSD1680_Send(&hepd, SSD1680_VCOM_VOLTAGE, vcomVoltage, sizeof(vcomVoltage));  // 0x2C
+  for (uint8_t i = 0; i < profile->Step_Count; ++i) {
+    const SSD1680_InitStepTypeDef *step = &profile->Steps[i];
+    if ((status = SSD1680_Send(hepd, step->Command, step->Args, step->Size)))
+      return status;
+    if ((step->Flags & SSD1680_INIT_WAIT) && (status = SSD1680_Wait(hepd)))
+      return status;
+  }
 
-  SSD1680_GateScanRange(hepd, 0, hepd->Resolution_Y);
-  SSD1680_UpdateControl(hepd);
+  if ((status = SSD1680_GateScanRange(hepd, 0, hepd->Resolution_Y)))
+    return status;
+  if ((status = SSD1680_UpdateControl(hepd)))
+    return status;
+  if ((status = SSD1680_DataEntryMode(hepd, RightThenDown)))
+    return status;
 
-  /***** #4 *****/
-  SSD1680_DataEntryMode(hepd, RightThenDown);
+#if defined(DEBUG)
+  if (hepd->LED_Port)
+    HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_SET);
+#endif // DEBUG
+  return SSD1680_Settle(hepd);
+}
 
-  /***** #5 *****/
-  /* Use SD1680 internal temperature sensor */
-/*
-  const uint8_t tempSensor[] = { 0x80 };
-  SSD1680_Send(hepd, SSD1680_SELECT_TEMP_SENSOR, tempSensor, sizeof(tempSensor));    // 0x18
-*/
+/**
+ * @brief Put the display into deep sleep
+ * @details Pending copy of previous image is made and analog is disabled before.
+ * The display doesn't respond until SSD1680_Resume. Shadow copy of registers is invalidated,
+ * the values known before are kept for SSD1680_Resume to restore.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] mode: Deep sleep mode
+ * @return HAL status
+ * @see SSD1680_Resume
+ */
+HAL_StatusTypeDef SSD1680_Sleep(SSD1680_HandleTypeDef *hepd, const enum SSD1680_SleepMode mode) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (mode == DeepSleep1 && (status = SSD1680_CopyPrevious(hepd)))
+    return status;
+  hepd->Copy_Pending = 0;
+  if ((status = SSD1680_PowerDown(hepd)))
+    return status;
+  const uint8_t sleepMode = mode;
+  if ((status = SSD1680_Send(hepd, SSD1680_DEEP_SLEEP, &sleepMode, sizeof(sleepMode))))  // 0x10
+    return status;
+  hepd->Sleep_Valid = hepd->Shadow.Valid;
+  SSD1680_InvalidateShadow(hepd);
+  hepd->Sleep = mode;
+  return status;
+}
 
-  /* Load temperature value */
-/*
-  const uint8_t loadTemp[] = { 0xB1 };
-  SSD1680_Send(hepd, SSD1680_UPDATE_CONTROL_2, loadTemp, sizeof(loadTemp));	// 0x22
-  SSD1680_Send(hepd, SSD1680_MASTER_ACTIVATION, NULL, 0);	// 0x20
-  SSD1680_Wait(hepd);
-*/
+/**
+ * @brief Wake the display up from deep sleep
+ * @details After @ref DeepSleep1 the display is woken up by hardware reset and the registers known before are restored.
+ * RAM content survives so nothing is uploaded again. LUT is loaded by the next refresh.
+ * After @ref DeepSleep2 the display is fully reinitialized.
+ * Time taken is reported in @ref SSD1680_HandleTypeDef::Resume_Duration.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ * @see SSD1680_Sleep
+ */
+HAL_StatusTypeDef SSD1680_Resume(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  const uint32_t start = HAL_GetTick();
+  const uint8_t mode = hepd->Sleep;
+  if (!mode)
+    return status;
+  hepd->Sleep = 0;
+  if (mode != DeepSleep1) {
+    status = SSD1680_Init(hepd);
+  } else {
+    SSD1680_ShadowTypeDef shadow = hepd->Shadow;
+    shadow.Valid = hepd->Sleep_Valid;
+    hepd->LUT_Valid = 0;
+    hepd->LUT_Profile = NULL;
+    hepd->LUT_Lost = 1;
+    HAL_GPIO_WritePin(hepd->RESET_Port, hepd->RESET_Pin, GPIO_PIN_RESET);
+    HAL_Delay(1);
+    HAL_GPIO_WritePin(hepd->RESET_Port, hepd->RESET_Pin, GPIO_PIN_SET);
+    SSD1680_BusyStart(hepd, SSD1680_SW_RESET);
+    if (!(status = SSD1680_Wait(hepd)) && !(status = SSD1680_Replay(hepd, &shadow))) {
+      // LUT is loaded from temperature register
+      const uint8_t temp[] = { hepd->Temp_Known ? hepd->Temp : 0x64, 0x00 };
+      status = SSD1680_Send(hepd, SSD1680_WRITE_TEMP, temp, sizeof(temp));  // 0x1A
+    }
+  }
+  hepd->Resume_Duration = HAL_GetTick() - start;
+  return status;
+}
 
-  /* Write temperature register */
-  const uint8_t temp[] = { 0x64 };
-  SSD1680_Send(hepd, SSD1680_WRITE_TEMP, temp, sizeof(temp)); // 0x1A
+/**
+ * @brief Append horizontal RAM range to a transaction
+ * @param[in] tx: transaction
+ * @param[in] left: start of the range. Must be multiple of 8.
+ * @param[in] width: width of the range. Must be multiple of 8.
+ * @return HAL status
+ * @see SSD1680_RAMXRange
+ */
+static HAL_StatusTypeDef SSD1680_AddRAMXRange(SSD1680_TransactionTypeDef *tx, const uint8_t left, const uint8_t width) {
+  if (left % 8 + width % 8)
+    return HAL_ERROR;
+  const uint8_t ramXRange[] = { left / 8, (left + width) / 8 - 1};
+  return SSD1680_TransactionAdd(tx, SSD1680_RAM_X_RANGE, ramXRange, sizeof(ramXRange));   // 0x44
+}
 
-  /* Load temperature value */
-  const uint8_t temp2[] = { 0x91 };
-  SSD1680_Send(hepd, SSD1680_UPDATE_CONTROL_2, temp2, sizeof(temp2));	// 0x22
-  SSD1680_Send(hepd, SSD1680_MASTER_ACTIVATION, NULL, 0);	// 0x20
-  SSD1680_Wait(hepd);
+/**
+ * @brief Append vertical RAM range to a transaction
+ * @param[in] tx: transaction
+ * @param[in] top: start of the range.
+ * @param[in] height: height of the range.
+ * @return HAL status
+ * @see SSD1680_RAMYRange
+ */
+static HAL_StatusTypeDef SSD1680_AddRAMYRange(SSD1680_TransactionTypeDef *tx, const uint16_t top, const uint16_t height) {
+  const uint16_t ramYRange[] = { top, (top + height) - 1};
+  return SSD1680_TransactionAdd(tx, SSD1680_RAM_Y_RANGE, (uint8_t *)ramYRange, sizeof(ramYRange));   // 0x45
+}
 
-#if defined(DEBUG)
-  if (hepd->LED_Port)
-    HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_SET);
-#endif // DEBUG
+/**
+ * @brief Append RAM start address to a transaction
+ * @param[in] tx: transaction
+ * @param[in] x: column. Must be multiple of 8.
+ * @param[in] y: row
+ * @return HAL status
+ * @see SSD1680_StartAddress
+ */
+static HAL_StatusTypeDef SSD1680_AddStartAddress(SSD1680_TransactionTypeDef *tx, const uint8_t x, const uint16_t y) {
+  if (x % 8)
+    return HAL_ERROR;
+  HAL_StatusTypeDef status = HAL_OK;
+  const uint8_t xaddr = x / 8;
+  if ((status = SSD1680_TransactionAdd(tx, SSD1680_RAM_X, &xaddr, sizeof(xaddr))))   // 0x4E
+    return status;
+  return SSD1680_TransactionAdd(tx, SSD1680_RAM_Y, (uint8_t *)&y, sizeof(y));   // 0x4F
 }
 
 /**
@@ -277,10 +1047,12 @@ void SSD1680_Init(SSD1680_HandleTypeDef *hepd) {
  * @see SSD1680_RAMYRange
  */
 HAL_StatusTypeDef SSD1680_RAMXRange(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint8_t width) {
-  if (left % 8 + width % 8)
-    return HAL_ERROR;
-  const uint8_t ramXRange[] = { left / 8, (left + width) / 8 - 1};
-  return SSD1680_Send(hepd, SSD1680_RAM_X_RANGE, ramXRange, sizeof(ramXRange));   // 0x44
+  HAL_StatusTypeDef status = HAL_OK;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_AddRAMXRange(&tx, left, width)))
+    return status;
+  return SSD1680_TransactionCommit(&tx);
 }
 
 /**
@@ -297,83 +1069,898 @@ HAL_StatusTypeDef SSD1680_RAMXRange(SSD1680_HandleTypeDef *hepd, const uint8_t l
  * @see SSD1680_RAMXRange
  */
 HAL_StatusTypeDef SSD1680_RAMYRange(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height) {
-  const uint16_t ramYRange[] = { top, (top + height) - 1};
-  return SSD1680_Send(hepd, SSD1680_RAM_Y_RANGE, (uint8_t *)ramYRange, sizeof(ramYRange));   // 0x45
+  HAL_StatusTypeDef status = HAL_OK;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_AddRAMYRange(&tx, top, height)))
+    return status;
+  return SSD1680_TransactionCommit(&tx);
+}
+
+/**
+ * @brief Shows checker pattern
+ * @details Fills the screen with checker pattern with specified strides for primary and secondary colors.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] kx: horizontal stride for primary color
+ * @param[in] ky: vertical stride for primary color
+ * @param[in] rx: horizontal stride for secondary color
+ * @param[in] ry: vertical stride for secondary color
+ * @param[in] color: color of the top-left pixel
+ * @return HAL status
+ * @note Slow. Waits for display ready unless @ref SSD1680_HandleTypeDef::Lazy_Wait is set.
+ * @see SSD1680_Checker for common test pattern
+ */
+HAL_StatusTypeDef SSD1680_RAMFill(SSD1680_HandleTypeDef *hepd, const enum SSD1680_Pattern kx, const enum SSD1680_Pattern ky, const enum SSD1680_Pattern rx, const enum SSD1680_Pattern ry, const enum SSD1680_Color color) {
+  HAL_StatusTypeDef status = HAL_OK;
+  const uint8_t fill[] = { SSD1680_PATTERN_BLACK, (ky << 4) | kx | ((color & 1) << 7), SSD1680_PATTERN_RED, (ry << 4) | rx | ((color & 2) << 6) };
+  if (SSD1680_Hashing(hepd))
+    SSD1680_Hash(hepd, fill, sizeof(fill));
+  if (hepd->Frame_Dry)
+    return status;
+  if ((status = SSD1680_CopyPrevious(hepd)))
+    return status;
+  SSD1680_MarkDirty(hepd, 0, 0, hepd->Resolution_X, hepd->Resolution_Y);
+  if ((status = SSD1680_RAMXRange(hepd, 0, hepd->Resolution_X)))
+    return status;
+  if ((status = SSD1680_RAMYRange(hepd, 0, hepd->Resolution_Y)))
+    return status;
+  uint8_t pattern = fill[1];
+  if ((status = SSD1680_Send(hepd, SSD1680_PATTERN_BLACK, &pattern, sizeof(pattern))))  // 0x47
+    return status;
+  pattern = fill[3];
+  if ((status = SSD1680_Send(hepd, SSD1680_PATTERN_RED, &pattern, sizeof(pattern))))  // 0x46
+    return status;
+  return SSD1680_Settle(hepd);
+}
+
+/**
+ * @brief Clears the screen
+ * @details Fills the screen with specified solid color
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] color: color to fill the screen
+ * @return HAL status
+ * @note Slow. Waits for display ready unless @ref SSD1680_HandleTypeDef::Lazy_Wait is set.
+ */
+HAL_StatusTypeDef SSD1680_Clear(SSD1680_HandleTypeDef *hepd, const enum SSD1680_Color color) {
+  return SSD1680_RAMFill(hepd, PatternSolid, PatternSolid, PatternSolid, PatternSolid, color);
+}
+
+/**
+ * @brief Shows checker pattern
+ * @details Fills the screen with checker pattern 16x16 for primary (black) color and 8x8 for secondary (red) color.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ * @note Slow. Waits for display ready unless @ref SSD1680_HandleTypeDef::Lazy_Wait is set.
+ * @see SSD1680_RAMFill for custom patterns
+ */
+HAL_StatusTypeDef SSD1680_Checker(SSD1680_HandleTypeDef *hepd) {
+  return SSD1680_RAMFill(hepd, Pattern16, Pattern16, Pattern8, Pattern8, ColorAnotherRed);
+}
+
+/**
+ * @brief Disable analog and clock left running by burst refresh
+ * @details Does nothing if they are already off.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ * @see SSD1680_HandleTypeDef::Burst_Idle
+ */
+HAL_StatusTypeDef SSD1680_PowerDown(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (!hepd->Analog_On)
+    return status;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  const uint8_t powerOff = SSD1680_POWER_OFF;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_UPDATE_CONTROL_2, &powerOff, sizeof(powerOff))))  // 0x22
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_MASTER_ACTIVATION, NULL, 0)))   // 0x20
+    return status;
+  if ((status = SSD1680_TransactionCommit(&tx)))
+    return status;
+  hepd->Analog_On = 0;
+  return SSD1680_Settle(hepd);
+}
+
+/**
+ * @brief Sense temperature with internal sensor
+ * @details Loads temperature value without loading LUT and reads it back.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[out] temp: temperature in °C
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_SenseTemp(SSD1680_HandleTypeDef *hepd, int8_t *temp) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if ((status = SSD1680_PowerDown(hepd)))
+    return status;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  const uint8_t tempSensor = 0x80;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_SELECT_TEMP_SENSOR, &tempSensor, sizeof(tempSensor))))  // 0x18
+    return status;
+  const uint8_t loadTemp = 0xA1;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_UPDATE_CONTROL_2, &loadTemp, sizeof(loadTemp))))   // 0x22
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_MASTER_ACTIVATION, NULL, 0)))   // 0x20
+    return status;
+  if ((status = SSD1680_TransactionCommit(&tx)))
+    return status;
+  if ((status = SSD1680_Wait(hepd)))
+    return status;
+  uint8_t value[2];
+  if ((status = SSD1680_Receive(hepd, SSD1680_READ_TEMP, value, sizeof(value))))  // 0x1B
+    return status;
+  *temp = (int8_t)value[0];
+  return status;
+}
+
+/**
+ * @brief Get current temperature
+ * @details Senses internal sensor if temperature is older than @ref SSD1680_HandleTypeDef::Temp_Interval.
+ * Temperature supplied with SSD1680_SetTemp is returned as is.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[out] temp: temperature in °C
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_CurrentTemp(SSD1680_HandleTypeDef *hepd, int8_t *temp) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (!hepd->Temp_External && (!hepd->Temp_Known || HAL_GetTick() - hepd->Temp_Time >= hepd->Temp_Interval)) {
+    if ((status = SSD1680_SenseTemp(hepd, &hepd->Temp)))
+      return status;
+    hepd->Temp_Time = HAL_GetTick();
+    hepd->Temp_Known = 1;
+  }
+  *temp = hepd->Temp;
+  return status;
+}
+
+/**
+ * @brief Check custom LUT profile
+ * @param[in] profile: custom LUT profile
+ * @return HAL status
+ * @retval HAL_ERROR if temperature band is empty, gate voltage is out of range or LUT is blank
+ */
+static HAL_StatusTypeDef SSD1680_CheckLUT(const SSD1680_LUTProfileTypeDef *profile) {
+  if (!profile || profile->Temp_Min > profile->Temp_Max || profile->Gate_Voltage > 0x17)
+    return HAL_ERROR;
+  for (uint8_t i = 0; i < SSD1680_LUT_SIZE; ++i)
+    if (profile->LUT[i])
+      return HAL_OK;
+  return HAL_ERROR;
+}
+
+/**
+ * @brief Upload custom waveform LUT and driving voltages
+ * @details The LUT stays in effect until refresh loads LUT from OTP or display is reset.
+ * Voltages already in effect are not sent again.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] profile: custom LUT profile. Must stay valid while in use.
+ * @return HAL status
+ * @retval HAL_ERROR if profile is malformed
+ * @see SSD1680_HandleTypeDef::LUT_Profiles for automatic selection by temperature
+ */
+HAL_StatusTypeDef SSD1680_WriteLUT(SSD1680_HandleTypeDef *hepd, const SSD1680_LUTProfileTypeDef *profile) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if ((status = SSD1680_CheckLUT(profile)))
+    return status;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_WRITE_LUT, profile->LUT, sizeof(profile->LUT))))  // 0x32
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_END_OPTION, &profile->End_Option, sizeof(profile->End_Option))))  // 0x3F
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_GATE_VOLTAGE, &profile->Gate_Voltage, sizeof(profile->Gate_Voltage))))  // 0x03
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_SOURCE_VOLTAGE, profile->Source_Voltage, sizeof(profile->Source_Voltage))))  // 0x04
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_VCOM_VOLTAGE, &profile->VCOM_Voltage, sizeof(profile->VCOM_Voltage))))  // 0x2C
+    return status;
+  if ((status = SSD1680_TransactionCommit(&tx)))
+    return status;
+  hepd->LUT_Profile = profile;
+  hepd->LUT_Valid = 0;
+  hepd->LUT_Lost = 0;
+  return status;
+}
+
+/**
+ * @brief Choose update control sequence 2 for refresh
+ * @details Partial refresh uses custom LUT profile matching current temperature if there is one.
+ * The profile is uploaded only when it differs from the one already in effect.
+ * Otherwise strips temperature and LUT loading from refresh mode while the loaded OTP LUT is still good for the cached temperature.
+ * Internal sensor is sensed once in @ref SSD1680_HandleTypeDef::Temp_Interval and LUT is reloaded
+ * only if temperature drifted by more than @ref SSD1680_HandleTypeDef::Temp_Delta.
+ * Temperature supplied with SSD1680_SetTemp is written to temperature register and LUT is loaded for it.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] mode: Refresh mode
+ * @param[out] sequence: update control sequence 2
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_RefreshSequence(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode, uint8_t *sequence) {
+  HAL_StatusTypeDef status = HAL_OK;
+  int8_t temp;
+  *sequence = mode;
+  if (hepd->LUT_Profiles && (mode & SSD1680_DISPLAY_MODE_2)) {
+    if ((status = SSD1680_CurrentTemp(hepd, &temp)))
+      return status;
+    for (uint8_t i = 0; i < hepd->LUT_Profile_Count; ++i) {
+      const SSD1680_LUTProfileTypeDef *profile = &hepd->LUT_Profiles[i];
+      if (temp < profile->Temp_Min || temp > profile->Temp_Max)
+        continue;
+      if (profile != hepd->LUT_Profile && (status = SSD1680_WriteLUT(hepd, profile)))
+        return status;
+      *sequence &= ~(SSD1680_LOAD_TEMP | SSD1680_LOAD_LUT);
+      return status;
+    }
+  }
+  if (!(mode & SSD1680_LOAD_LUT))
+    return status;
+  if (hepd->Temp_External) {
+    if (hepd->LUT_Valid) {
+      *sequence &= ~(SSD1680_LOAD_TEMP | SSD1680_LOAD_LUT);
+      return status;
+    }
+    const uint8_t tempValue[] = { hepd->LUT_Temp, 0x00 };
+    if ((status = SSD1680_Send(hepd, SSD1680_WRITE_TEMP, tempValue, sizeof(tempValue))))  // 0x1A
+      return status;
+    *sequence &= ~SSD1680_LOAD_TEMP;
+    return status;
+  }
+  if (!hepd->Temp_Interval)
+    return status;
+  if ((status = SSD1680_CurrentTemp(hepd, &temp)))
+    return status;
+  if (hepd->LUT_Valid && abs(temp - hepd->LUT_Temp) <= hepd->Temp_Delta) {
+    *sequence &= ~(SSD1680_LOAD_TEMP | SSD1680_LOAD_LUT);
+    return status;
+  }
+  hepd->LUT_Temp = temp;
+  hepd->LUT_Valid = 0;
+  *sequence &= ~SSD1680_LOAD_TEMP;
+  return status;
+}
+
+/**
+ * @brief Schedule copy of the displayed part of changed region into secondary (red) RAM bank
+ * @details Rows outside of the band stay changed. The copy is made by SSD1680_CopyPrevious
+ * before the next change of primary (black) RAM bank, the next refresh or in SSD1680_Process.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] top: topmost row being updated
+ * @param[in] height: number of rows being updated
+ */
+static void SSD1680_Displayed(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height) {
+  SSD1680_BoxTypeDef *box = &hepd->Diff_Box;
+  const uint16_t bottom = top + height;
+  if (box->Right <= box->Left || bottom <= box->Top || top >= box->Bottom)
+    return;
+  hepd->Copy_Box = *box;
+  if (top > hepd->Copy_Box.Top)
+    hepd->Copy_Box.Top = top;
+  if (bottom < hepd->Copy_Box.Bottom)
+    hepd->Copy_Box.Bottom = bottom;
+  hepd->Copy_Pending = 1;
+  if (top <= box->Top && bottom >= box->Bottom)
+    box->Bottom = box->Top;
+  else if (top <= box->Top)
+    box->Top = bottom;
+  else if (bottom >= box->Bottom)
+    box->Bottom = top;
+}
+
+/**
+ * @brief Move energy accounting window to the current time
+ * @details Slots left behind are cleared.
+ * @param[in] hepd: SSD1680 handle pointer
+ */
+static void SSD1680_EnergyAdvance(SSD1680_HandleTypeDef *hepd) {
+  SSD1680_EnergyLedgerTypeDef *ledger = hepd->Energy_Ledger;
+  const uint32_t now = HAL_GetTick();
+  uint32_t slot = hepd->Energy_Window / SSD1680_ENERGY_SLOTS;
+  if (!slot)
+    slot = 1;
+  for (uint8_t i = 0; i < SSD1680_ENERGY_SLOTS && now - ledger->Start >= slot; ++i) {
+    ledger->Slot = (ledger->Slot + 1) % SSD1680_ENERGY_SLOTS;
+    ledger->Used[ledger->Slot] = 0;
+    ledger->Start += slot;
+  }
+  if (now - ledger->Start >= slot)
+    ledger->Start = now;
+}
+
+/**
+ * @brief Check if energy governor is enabled
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return Non-zero if both energy model and ledger are set
+ */
+static inline uint8_t SSD1680_Governed(SSD1680_HandleTypeDef *hepd) {
+  return hepd->Energy_Model && hepd->Energy_Ledger;
+}
+
+/**
+ * @brief Estimate energy of refresh
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] height: number of rows to be updated
+ * @param[in] mode: Refresh mode
+ * @param[in] bypassR: non-zero if secondary (red) color is not driven
+ * @return Energy
+ * @see SSD1680_EnergyModelTypeDef
+ */
+static uint32_t SSD1680_EnergyCost(SSD1680_HandleTypeDef *hepd, const uint16_t height, const enum SSD1680_RefreshMode mode, const uint8_t bypassR) {
+  const SSD1680_EnergyModelTypeDef *model = hepd->Energy_Model;
+  uint32_t perRow;
+  switch (mode) {
+  case PartialRefresh:
+    perRow = model->Partial;
+    break;
+  case FastFullRefresh:
+    perRow = model->Fast_Full;
+    break;
+  case FastPartialRefresh:
+    perRow = model->Fast_Partial;
+    break;
+  default:
+    perRow = model->Full;
+    break;
+  }
+  if (!bypassR && !(hepd->Color_Depth & 0x01))
+    perRow += model->Red;
+  return model->Fixed + perRow * height;
+}
+
+/**
+ * @brief Get energy left in the accounting window
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return Energy
+ * @see SSD1680_HandleTypeDef::Energy_Budget
+ * @note Whole budget is left if there is no @ref SSD1680_HandleTypeDef::Energy_Ledger
+ */
+uint32_t SSD1680_EnergyRemaining(SSD1680_HandleTypeDef *hepd) {
+  if (!hepd->Energy_Ledger)
+    return hepd->Energy_Budget;
+  SSD1680_EnergyAdvance(hepd);
+  uint32_t used = 0;
+  for (uint8_t i = 0; i < SSD1680_ENERGY_SLOTS; ++i)
+    used += hepd->Energy_Ledger->Used[i];
+  return used < hepd->Energy_Budget ? hepd->Energy_Budget - used : 0;
+}
+
+/**
+ * @brief Fit refresh into energy budget
+ * @details Skips secondary (red) color first, then downgrades to @ref FastPartialRefresh.
+ * If it still doesn't fit, the refresh is deferred unless it is urgent.
+ * Only deferral is counted here, the rest is counted by SSD1680_GovernCount once the refresh is started.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] height: number of rows to be updated
+ * @param[in] urgent: non-zero to overdraw the budget rather than defer
+ * @param[in,out] mode: Refresh mode
+ * @param[in,out] bypassR: non-zero if secondary (red) color is not driven
+ * @param[out] verdict: `SSD1680_GOVERN_*` bits of what was done to fit
+ * @return HAL status
+ * @retval HAL_BUSY if refresh is deferred
+ * @see SSD1680_GetGovernorStats
+ */
+static HAL_StatusTypeDef SSD1680_Govern(SSD1680_HandleTypeDef *hepd, const uint16_t height, const uint8_t urgent,
+    enum SSD1680_RefreshMode *mode, uint8_t *bypassR, uint8_t *verdict) {
+  *verdict = 0;
+  if (!SSD1680_Governed(hepd))
+    return HAL_OK;
+  const uint32_t remaining = SSD1680_EnergyRemaining(hepd);
+  if (SSD1680_EnergyCost(hepd, height, *mode, *bypassR) <= remaining)
+    return HAL_OK;
+  if (!*bypassR && !(hepd->Color_Depth & 0x01)) {
+    *bypassR = 1;
+    *verdict |= SSD1680_GOVERN_RED;
+    if (SSD1680_EnergyCost(hepd, height, *mode, *bypassR) <= remaining)
+      return HAL_OK;
+  }
+  if (*mode != FastPartialRefresh) {
+    *mode = FastPartialRefresh;
+    *verdict |= SSD1680_GOVERN_DOWNGRADE;
+    if (SSD1680_EnergyCost(hepd, height, *mode, *bypassR) <= remaining)
+      return HAL_OK;
+  }
+  if (urgent) {
+    *verdict |= SSD1680_GOVERN_OVERDRAW;
+    return HAL_OK;
+  }
+  ++hepd->Governor_Stats.Deferred;
+  return HAL_BUSY;
+}
+
+/**
+ * @brief Count energy governor verdict of started refresh
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] verdict: `SSD1680_GOVERN_*` bits set by SSD1680_Govern
+ * @see SSD1680_GetGovernorStats
+ */
+static void SSD1680_GovernCount(SSD1680_HandleTypeDef *hepd, const uint8_t verdict) {
+  SSD1680_GovernorStatsTypeDef *stats = &hepd->Governor_Stats;
+  if (!verdict)
+    ++stats->Allowed;
+  if (verdict & SSD1680_GOVERN_RED)
+    ++stats->Red_Skipped;
+  if (verdict & SSD1680_GOVERN_DOWNGRADE)
+    ++stats->Downgraded;
+  if (verdict & SSD1680_GOVERN_OVERDRAW)
+    ++stats->Overdrawn;
+}
+
+/**
+ * @brief Get ghosting heatmap tile of a row
+ * @param[in] row: row
+ * @return tile index
+ */
+static inline uint8_t SSD1680_GhostTile(const uint16_t row) {
+  const uint16_t tile = row / SSD1680_GHOST_TILE_ROWS;
+  return tile < SSD1680_GHOST_TILES ? tile : SSD1680_GHOST_TILES - 1;
+}
+
+/**
+ * @brief Pick the cheapest refresh mode keeping ghosting within budget
+ * @details Full refresh is extended to whole tiles to clear them. It is always picked without the heatmap.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in,out] top: topmost row to be updated
+ * @param[in,out] height: number of rows to be updated
+ * @return Refresh mode
+ * @see SSD1680_HandleTypeDef::Ghost_Budget
+ */
+static enum SSD1680_RefreshMode SSD1680_AutoMode(SSD1680_HandleTypeDef *hepd, uint16_t *top, uint16_t *height) {
+  const uint8_t first = SSD1680_GhostTile(*top);
+  const uint8_t last = SSD1680_GhostTile(*top + *height - 1);
+  // Untracked ghosting is taken as over any budget
+  uint8_t level = hepd->Ghost ? 0 : 255;
+  for (uint8_t tile = first; tile <= last && hepd->Ghost; ++tile)
+    if (hepd->Ghost->Level[tile] > level)
+      level = hepd->Ghost->Level[tile];
+  if (level + 2 <= hepd->Ghost_Budget)
+    return FastPartialRefresh;
+  if (level + 1 <= hepd->Ghost_Budget)
+    return PartialRefresh;
+  uint16_t bottom = last + 1 < SSD1680_GHOST_TILES ? (last + 1) * SSD1680_GHOST_TILE_ROWS : hepd->Resolution_Y;
+  if (bottom > hepd->Resolution_Y)
+    bottom = hepd->Resolution_Y;
+  *top = first * SSD1680_GHOST_TILE_ROWS;
+  *height = bottom - *top;
+  return FullRefresh;
+}
+
+/**
+ * @brief Account refresh in ghosting heatmap
+ * @details Fast modes add 2, partial refresh adds 1. Full refresh clears tiles it covers entirely.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] top: topmost row being updated
+ * @param[in] height: number of rows being updated
+ * @param[in] mode: Refresh mode
+ */
+static void SSD1680_Ghost(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode) {
+  uint8_t *level = hepd->Ghost->Level;
+  const uint16_t bottom = top + height;
+  const uint8_t weight = (mode & SSD1680_LOAD_LUT) ? 1 : 2;
+  for (uint8_t tile = SSD1680_GhostTile(top); tile <= SSD1680_GhostTile(bottom - 1); ++tile) {
+    if (!(mode & SSD1680_DISPLAY_MODE_2) && (mode & SSD1680_LOAD_LUT)) {
+      const uint16_t tileTop = tile * SSD1680_GHOST_TILE_ROWS;
+      const uint16_t tileBottom = tile + 1 < SSD1680_GHOST_TILES ? tileTop + SSD1680_GHOST_TILE_ROWS : hepd->Resolution_Y;
+      if (top <= tileTop && (bottom >= tileBottom || bottom >= hepd->Resolution_Y))
+        level[tile] = 0;
+      continue;
+    }
+    level[tile] = level[tile] > 255 - weight ? 255 : level[tile] + weight;
+  }
+}
+
+/**
+ * @brief Clean overworked band of rows with full refresh
+ * @details The band spans from the first to the last tile at @ref SSD1680_HandleTypeDef::Ghost_Clean level or above.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_Clean(SSD1680_HandleTypeDef *hepd) {
+  uint16_t top = hepd->Resolution_Y;
+  uint16_t bottom = 0;
+  for (uint8_t tile = 0; tile <= SSD1680_GhostTile(hepd->Resolution_Y - 1); ++tile) {
+    if (hepd->Ghost->Level[tile] < hepd->Ghost_Clean)
+      continue;
+    if (tile * SSD1680_GHOST_TILE_ROWS < top)
+      top = tile * SSD1680_GHOST_TILE_ROWS;
+    bottom = tile + 1 < SSD1680_GHOST_TILES ? (tile + 1) * SSD1680_GHOST_TILE_ROWS : hepd->Resolution_Y;
+  }
+  if (bottom > hepd->Resolution_Y)
+    bottom = hepd->Resolution_Y;
+  if (bottom <= top)
+    return HAL_OK;
+  // Cleaning isn't worth degrading
+  if (SSD1680_Governed(hepd) && SSD1680_EnergyCost(hepd, bottom - top, FullRefresh, hepd->Color_Depth & 0x01) > SSD1680_EnergyRemaining(hepd))
+    return HAL_OK;
+  return SSD1680_RefreshRegion_IT(hepd, top, bottom - top, FullRefresh);
+}
+
+/**
+ * @brief Get temperature refresh duration model is keyed on
+ * @details Doesn't talk to the display. Uses temperature cached by refresh (see @ref SSD1680_HandleTypeDef::Temp_Interval)
+ * or supplied with SSD1680_SetTemp if known. Values returned by SSD1680_ReadTemp are not cached and don't count.
+ * After it is lost to reset the last known one is used for @ref SSD1680_MODEL_TEMP_PERIOD, then @ref SSD1680_MODEL_TEMP_DEFAULT.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return Temperature in °C
+ */
+static int8_t SSD1680_ModelTemp(SSD1680_HandleTypeDef *hepd) {
+  if (hepd->Temp_Known) {
+    hepd->Model_Temp = hepd->Temp;
+    hepd->Model_Temp_Time = HAL_GetTick();
+    hepd->Model_Temp_Valid = 1;
+  } else if (hepd->Model_Temp_Valid && HAL_GetTick() - hepd->Model_Temp_Time >= SSD1680_MODEL_TEMP_PERIOD) {
+    hepd->Model_Temp_Valid = 0;
+  }
+  return hepd->Model_Temp_Valid ? hepd->Model_Temp : SSD1680_MODEL_TEMP_DEFAULT;
+}
+
+/**
+ * @brief Find refresh duration model bucket
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] height: number of rows to be updated
+ * @param[in] mode: Refresh mode
+ * @param[in] temp: temperature in °C
+ * @return Model bucket or NULL if there is no model
+ */
+static uint16_t *SSD1680_ModelBucket(SSD1680_HandleTypeDef *hepd, const uint16_t height, const enum SSD1680_RefreshMode mode, const int8_t temp) {
+  if (!hepd->Refresh_Model)
+    return NULL;
+  const uint8_t modeIndex = ((mode & SSD1680_LOAD_LUT) ? 0 : 2) + ((mode & SSD1680_DISPLAY_MODE_2) ? 1 : 0);
+  const uint8_t heightIndex = (height * SSD1680_MODEL_HEIGHTS - 1) / hepd->Resolution_Y;
+  int16_t tempIndex = temp < SSD1680_MODEL_TEMP_MIN ? 0 : (temp - SSD1680_MODEL_TEMP_MIN) / SSD1680_MODEL_TEMP_STEP + 1;
+  if (tempIndex >= SSD1680_MODEL_TEMPS)
+    tempIndex = SSD1680_MODEL_TEMPS - 1;
+  return &hepd->Refresh_Model->Duration[modeIndex][heightIndex][tempIndex];
+}
+
+/**
+ * @brief Predict refresh duration
+ * @details Duration is learned from completed refreshes with similar mode, band height and temperature.
+ * Doesn't talk to the display: temperature is the cached or supplied one, SSD1680_ReadTemp doesn't affect prediction.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] top: topmost row to be updated
+ * @param[in] height: number of rows to be updated
+ * @param[in] mode: Refresh mode
+ * @return Duration in ms or 0 if unknown or there is no @ref SSD1680_HandleTypeDef::Refresh_Model
+ * @see SSD1680_ExpectedReady
+ */
+uint32_t SSD1680_PredictRefresh(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode) {
+  if (!height || top + height > hepd->Resolution_Y)
+    return 0;
+  uint16_t autoTop = top;
+  uint16_t autoHeight = height;
+  const enum SSD1680_RefreshMode actual = mode == AutoRefresh ? SSD1680_AutoMode(hepd, &autoTop, &autoHeight) : mode;
+  const uint16_t *bucket = SSD1680_ModelBucket(hepd, autoHeight, actual, SSD1680_ModelTemp(hepd));
+  return bucket ? *bucket : 0;
+}
+
+/**
+ * @brief Predict when the display becomes ready
+ * @details Falls back to the timeout of busy period if refresh duration is unknown.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return Time in ms as in HAL_GetTick
+ * @see SSD1680_PredictRefresh
+ */
+uint32_t SSD1680_ExpectedReady(SSD1680_HandleTypeDef *hepd) {
+  if (SSD1680_GetState(hepd) != StateBusy)
+    return HAL_GetTick();
+  return hepd->Busy_Start + (hepd->Busy_Expected ? hepd->Busy_Expected : hepd->Busy_Limit);
+}
+
+static HAL_StatusTypeDef SSD1680_StartUpdate(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode, const uint8_t urgent);
+
+/**
+ * @brief Start pending requested refresh
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ * @see SSD1680_RequestRefresh
+ */
+static HAL_StatusTypeDef SSD1680_Dispatch(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  const uint32_t now = HAL_GetTick();
+  const uint8_t deadline = hepd->Deadline && now - hepd->Sched_First >= hepd->Deadline;
+  status = SSD1680_StartUpdate(hepd, hepd->Sched_Top, hepd->Sched_Bottom - hepd->Sched_Top, hepd->Sched_Mode, hepd->Sched_Urgent);
+  if (status == HAL_BUSY)
+    return HAL_OK;  // Deferred by energy governor. Keep merging requests.
+  if (status)
+    return status;
+  ++hepd->Sched_Stats.Refreshes;
+  if (hepd->Sched_Urgent)
+    ++hepd->Sched_Stats.Urgent;
+  else if (deadline && now - hepd->Sched_Last < hepd->Debounce)
+    ++hepd->Sched_Stats.Deadline_Hits;
+  hepd->Sched_Stats.Rows += hepd->Sched_Bottom - hepd->Sched_Top;
+  hepd->Sched_Pending = 0;
+  hepd->Sched_Urgent = 0;
+  return status;
+}
+
+/**
+ * @brief Start update of a band of rows
+ * @details Does the work of SSD1680_RefreshRegion_IT for the application and for requested refresh alike.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] top: topmost row to be updated
+ * @param[in] height: number of rows to be updated
+ * @param[in] mode: Refresh mode
+ * @param[in] urgent: non-zero to let energy governor overdraw the budget rather than defer
+ * @return HAL status
+ * @retval HAL_ERROR if band is empty or doesn't fit the screen
+ * @retval HAL_BUSY if refresh is deferred by energy governor
+ */
+static HAL_StatusTypeDef SSD1680_StartUpdate(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode, const uint8_t urgent) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (!height || top + height > hepd->Resolution_Y)
+    return HAL_ERROR;
+  if (mode == AutoRefresh) {
+    uint16_t autoTop = top;
+    uint16_t autoHeight = height;
+    const enum SSD1680_RefreshMode autoMode = SSD1680_AutoMode(hepd, &autoTop, &autoHeight);
+    return SSD1680_StartUpdate(hepd, autoTop, autoHeight, autoMode, urgent);
+  }
+  // Skip slow secondary color waveform if secondary RAM bank is unchanged. Differential refresh needs it for previous image.
+  uint8_t bypassR = ((hepd->Color_Depth & 0x01) && !hepd->Differential) || (hepd->Red_Bypass && !hepd->Red_Dirty);
+  enum SSD1680_RefreshMode actual = mode;
+  uint8_t verdict;
+  if ((status = SSD1680_Govern(hepd, height, urgent, &actual, &bypassR, &verdict)))
+    return status;
+  if ((status = SSD1680_CopyPrevious(hepd)))
+    return status;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_GATE_SCAN_START, (uint8_t *)&top, sizeof(top))))  // 0x0F
+    return status;
+#pragma pack(push, 1)
+  const struct {
+    uint16_t mux;
+    uint8_t order;
+  } gateScan = { height - 1, 0 };
+#pragma pack(pop)
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_GATE_SCAN, (uint8_t *)&gateScan, sizeof(gateScan))))   // 0x01
+    return status;
+  if ((status = SSD1680_AddUpdateControl(&tx, bypassR)))
+    return status;
+  const uint8_t boosterSoftStart[] = { 0x80, 0x90, 0x90, 0x00 };
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_BOOSTER_SOFT_START, boosterSoftStart, sizeof(boosterSoftStart))))    // 0x0C
+    return status;
+  uint8_t updateControl2;
+  if ((status = SSD1680_RefreshSequence(hepd, actual, &updateControl2)))
+    return status;
+  // LUT didn't survive deep sleep
+  if (hepd->LUT_Lost && !hepd->LUT_Profile)
+    updateControl2 |= SSD1680_LOAD_LUT;
+  // Keep clock and analog running between burst partial refreshes
+  if (hepd->Burst_Idle && (actual & SSD1680_DISPLAY_MODE_2)) {
+    updateControl2 &= ~SSD1680_POWER_OFF;
+    if (hepd->Analog_On)
+      updateControl2 &= ~SSD1680_POWER_ON;
+  }
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_UPDATE_CONTROL_2, &updateControl2, sizeof(updateControl2))))	// 0x22
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_MASTER_ACTIVATION, NULL, 0)))   // 0x20
+    return status;
+  uint16_t *bucket = SSD1680_ModelBucket(hepd, height, actual, SSD1680_ModelTemp(hepd));
+  // Screen content is unknown until refresh completes
+  if (hepd->Fingerprint)
+    hepd->Fingerprint->Magic = 0;
+  if ((status = SSD1680_TransactionCommit(&tx)))
+    return status;
+  hepd->Gate_Limited = top || height != hepd->Resolution_Y;
+  if (hepd->State == StateBusy) {
+    hepd->Busy_Expected = bucket ? *bucket : 0;
+    hepd->Model_Pending = bucket;
+  }
+  // Only full screen refresh makes the screen match the frame, the next frame is hashed from scratch
+  if (!top && height == hepd->Resolution_Y) {
+    if (hepd->Fingerprint) {
+      hepd->Fingerprint->Hash = hepd->Frame_Hash;
+      hepd->Fingerprint->Mode = actual;
+      if (hepd->State == StateBusy)
+        hepd->Fingerprint_Pending = 1;
+      else
+        hepd->Fingerprint->Magic = SSD1680_FINGERPRINT_MAGIC;
+    }
+    hepd->Frame_Hash = SSD1680_FNV_BASIS;
+  }
+  if (!bypassR)
+    hepd->Red_Dirty = 0;
+  if (SSD1680_Governed(hepd)) {
+    SSD1680_GovernCount(hepd, verdict);
+    SSD1680_EnergyAdvance(hepd);
+    hepd->Energy_Ledger->Used[hepd->Energy_Ledger->Slot] += SSD1680_EnergyCost(hepd, height, actual, bypassR);
+  }
+  if (hepd->Ghost)
+    SSD1680_Ghost(hepd, top, height, actual);
+  if (hepd->Differential)
+    SSD1680_Displayed(hepd, top, height);
+  hepd->Analog_On = !(updateControl2 & SSD1680_POWER_OFF);
+  if (updateControl2 & SSD1680_LOAD_LUT) {
+    hepd->LUT_Valid = hepd->Temp_External || hepd->Temp_Interval;
+    hepd->LUT_Profile = NULL;
+    hepd->LUT_Lost = 0;
+  }
+  return status;
+}
+
+/**
+ * @brief Start update of a band of rows
+ * @details Limits gate scan to the band of rows, starts update sequence and returns immediately.
+ * Gate scan range stays limited until the next refresh of other band or whole screen, or until SSD1680_Process restores it.
+ * If @ref SSD1680_HandleTypeDef::Red_Bypass is set and secondary (red) RAM bank wasn't written since the last refresh,
+ * secondary color channel is bypassed for this refresh.
+ * With @ref SSD1680_HandleTypeDef::Differential set the displayed image is copied into secondary (red) RAM bank afterwards.
+ * @ref AutoRefresh picks mode by ghosting heatmap.
+ * With @ref SSD1680_HandleTypeDef::Energy_Model and @ref SSD1680_HandleTypeDef::Energy_Ledger set the refresh may be degraded or deferred to fit energy budget.
+ * Deferred refresh is not started and HAL_BUSY is returned, only urgent SSD1680_RequestRefresh may overdraw the budget.
+ * Partial refreshes leave clock and analog running if @ref SSD1680_HandleTypeDef::Burst_Idle is set.
+ * Temperature and LUT are loaded once and cached if @ref SSD1680_HandleTypeDef::Temp_Interval is set or SSD1680_SetTemp is used.
+ * End of update is reported via @ref SSD1680_HandleTypeDef::Ready_Callback and by SSD1680_GetState returning @ref StateReady.
+ * Any subsequent command waits for update to complete.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] top: topmost row to be updated
+ * @param[in] height: number of rows to be updated
+ * @param[in] mode: Refresh mode
+ * @return HAL status
+ * @retval HAL_ERROR if band is empty or doesn't fit the screen
+ * @retval HAL_BUSY if refresh is deferred by energy governor
+ * @see SSD1680_RefreshRegion for blocking version
+ */
+HAL_StatusTypeDef SSD1680_RefreshRegion_IT(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode) {
+  return SSD1680_StartUpdate(hepd, top, height, mode, 0);
+}
+
+/**
+ * @brief Update a band of rows
+ * @details Limits gate scan to the band of rows so that only those rows are driven during update.
+ * Useful for status bars and other small areas. Full screen gate scan range is restored once the update completes,
+ * or by the next refresh or SSD1680_Process if @ref SSD1680_HandleTypeDef::Lazy_Wait is set.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] top: topmost row to be updated
+ * @param[in] height: number of rows to be updated
+ * @param[in] mode: Refresh mode
+ * @return HAL status
+ * @retval HAL_ERROR if band is empty or doesn't fit the screen
+ * @retval HAL_BUSY if refresh is deferred by energy governor. Nothing is started then.
+ * @note Slow. Waits for display to complete operation unless @ref SSD1680_HandleTypeDef::Lazy_Wait is set.
+ * @see SSD1680_RefreshRegion_IT for non-blocking version
+ */
+HAL_StatusTypeDef SSD1680_RefreshRegion(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if ((status = SSD1680_RefreshRegion_IT(hepd, top, height, mode)))
+    return status;
+  if ((status = SSD1680_Settle(hepd)) || hepd->Lazy_Wait)
+    return status;
+  return SSD1680_RestoreGateScan(hepd);
+}
+
+/**
+ * @brief Start display update
+ * @details Start update sequence to show internal memory content on the display and return immediately.
+ * End of update is reported via @ref SSD1680_HandleTypeDef::Ready_Callback and by SSD1680_GetState returning @ref StateReady.
+ * Any subsequent command waits for update to complete.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] mode: Refresh mode
+ * @return HAL status
+ * @retval HAL_BUSY if refresh is deferred by energy governor. Nothing is started then.
+ * @note Set @ref SSD1680_HandleTypeDef::BUSY_EXTI and call SSD1680_BUSY_EXTI_Callback from `HAL_GPIO_EXTI_Callback`
+ * to get completion without polling.
+ * @see SSD1680_Refresh for blocking version
+ */
+HAL_StatusTypeDef SSD1680_Refresh_IT(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode) {
+  return SSD1680_RefreshRegion_IT(hepd, 0, hepd->Resolution_Y, mode);
+}
+
+/**
+ * @brief Update the display
+ * @details Start update sequence to show internal memory content on the display.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] mode: Refresh mode
+ * @return HAL status
+ * @retval HAL_BUSY if refresh is deferred by energy governor. Nothing is started then.
+ * @note Slow. Waits for display to complete operation unless @ref SSD1680_HandleTypeDef::Lazy_Wait is set.
+ * In the latter case the wait is performed by the next command sent to the display.
+ * @see SSD1680_Refresh_IT for non-blocking version
+ */
+HAL_StatusTypeDef SSD1680_Refresh(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if ((status = SSD1680_Refresh_IT(hepd, mode)))
+    return status;
+  return SSD1680_Settle(hepd);
 }
 
 /**
- * @brief Shows checker pattern
- * @details Fills the screen with checker pattern with specified strides for primary and secondary colors.
+ * @brief Request update of a band of rows
+ * @details Requests are merged into a single refresh of the union of bands in the most robust of requested modes.
+ * @ref AutoRefresh yields to any explicit mode.
+ * The refresh is started by SSD1680_Process when no more requests came in @ref SSD1680_HandleTypeDef::Debounce ms
+ * or the first pending request is @ref SSD1680_HandleTypeDef::Deadline ms old.
+ * Urgent request starts the refresh right away if the display is ready, otherwise as soon as it becomes ready.
  * @param[in] hepd: SSD1680 handle pointer
- * @param[in] kx: horizontal stride for primary color
- * @param[in] ky: vertical stride for primary color
- * @param[in] rx: horizontal stride for secondary color
- * @param[in] ry: vertical stride for secondary color
- * @param[in] color: color of the top-left pixel
+ * @param[in] top: topmost row to be updated
+ * @param[in] height: number of rows to be updated
+ * @param[in] mode: Refresh mode
+ * @param[in] urgent: non-zero to skip debouncing
  * @return HAL status
- * @note Slow. Waits for display ready.
- * @see SSD1680_Checker for common test pattern
+ * @retval HAL_ERROR if band is empty or doesn't fit the screen
+ * @see SSD1680_GetSchedulerStats
  */
-HAL_StatusTypeDef SSD1680_RAMFill(SSD1680_HandleTypeDef *hepd, const enum SSD1680_Pattern kx, const enum SSD1680_Pattern ky, const enum SSD1680_Pattern rx, const enum SSD1680_Pattern ry, const enum SSD1680_Color color) {
-  HAL_StatusTypeDef status = HAL_OK;
-  if ((status = SSD1680_RAMXRange(hepd, 0, hepd->Resolution_X)))
-    return status;
-  if ((status = SSD1680_RAMYRange(hepd, 0, hepd->Resolution_Y)))
-    return status;
-  uint8_t pattern = (ky << 4) | kx | ((color & 1) << 7);
-  if ((status = SSD1680_Send(hepd, SSD1680_PATTERN_BLACK, &pattern, sizeof(pattern))))  // 0x47
-    return status;
-  SSD1680_Wait(hepd);
-  pattern = (ry << 4) | rx | ((color & 2) << 6);
-  if ((status = SSD1680_Send(hepd, SSD1680_PATTERN_RED, &pattern, sizeof(pattern))))  // 0x46
-    return status;
-  SSD1680_Wait(hepd);
-  return status;
+HAL_StatusTypeDef SSD1680_RequestRefresh(SSD1680_HandleTypeDef *hepd, const uint16_t top, const uint16_t height, const enum SSD1680_RefreshMode mode, const uint8_t urgent) {
+  if (!height || top + height > hepd->Resolution_Y)
+    return HAL_ERROR;
+  const uint32_t now = HAL_GetTick();
+  if (!hepd->Sched_Pending) {
+    hepd->Sched_Pending = 1;
+    hepd->Sched_Top = top;
+    hepd->Sched_Bottom = top + height;
+    hepd->Sched_Mode = mode;
+    hepd->Sched_First = now;
+  } else {
+    if (top < hepd->Sched_Top)
+      hepd->Sched_Top = top;
+    if (top + height > hepd->Sched_Bottom)
+      hepd->Sched_Bottom = top + height;
+    if (hepd->Sched_Mode == AutoRefresh) {
+      hepd->Sched_Mode = mode;
+    } else if (mode != AutoRefresh) {
+      // Full beats partial, slow beats fast
+      const uint8_t full = !(hepd->Sched_Mode & mode & SSD1680_DISPLAY_MODE_2);
+      const uint8_t slow = (hepd->Sched_Mode | mode) & SSD1680_LOAD_LUT;
+      hepd->Sched_Mode = (slow ? FullRefresh : FastFullRefresh) | (full ? 0 : SSD1680_DISPLAY_MODE_2);
+    }
+  }
+  hepd->Sched_Last = now;
+  hepd->Sched_Urgent |= urgent != 0;
+  ++hepd->Sched_Stats.Requests;
+  if (urgent && SSD1680_GetState(hepd) == StateReady)
+    return SSD1680_Dispatch(hepd);
+  return HAL_OK;
 }
 
 /**
- * @brief Clears the screen
- * @details Fills the screen with specified solid color
+ * @brief Start hashing a frame
+ * @details Restarts frame hash. Full screen refresh restarts it too, so frames displayed one after another need no call.
+ * In dry run RAM writes are only hashed and nothing is sent to the display.
+ * Render the frame after reboot in dry run and call @ref SSD1680_FrameUnchanged to skip both upload and refresh if the screen already shows it.
  * @param[in] hepd: SSD1680 handle pointer
- * @param[in] color: color to fill the screen
- * @return HAL status
- * @note Slow. Waits for display ready.
+ * @param[in] dryRun: non-zero to only hash RAM writes
+ * @see SSD1680_HandleTypeDef::Fingerprint
  */
-HAL_StatusTypeDef SSD1680_Clear(SSD1680_HandleTypeDef *hepd, const enum SSD1680_Color color) {
-  return SSD1680_RAMFill(hepd, PatternSolid, PatternSolid, PatternSolid, PatternSolid, color);
+void SSD1680_FrameBegin(SSD1680_HandleTypeDef *hepd, const uint8_t dryRun) {
+  hepd->Frame_Hash = SSD1680_FNV_BASIS;
+  hepd->Frame_Dry = dryRun;
 }
 
 /**
- * @brief Shows checker pattern
- * @details Fills the screen with checker pattern 16x16 for primary (black) color and 8x8 for secondary (red) color.
+ * @brief Check if the screen already shows the frame
+ * @details Compares hash of RAM writes since @ref SSD1680_FrameBegin or the last full screen refresh
+ * with the fingerprint stored by the last full screen refresh.
+ * The frame matches if it was displayed with the same mode or with @ref FullRefresh.
+ * Ends dry run and restarts frame hash.
  * @param[in] hepd: SSD1680 handle pointer
- * @return HAL status
- * @note Slow. Waits for display ready.
- * @see SSD1680_RAMFill for custom patterns
+ * @param[in] mode: refresh mode the frame is going to be displayed with
+ * @return Non-zero if the frame is on the screen
+ * @note Display RAM doesn't hold the frame after skipped upload. Upload it before the next refresh.
  */
-HAL_StatusTypeDef SSD1680_Checker(SSD1680_HandleTypeDef *hepd) {
-  return SSD1680_RAMFill(hepd, Pattern16, Pattern16, Pattern8, Pattern8, ColorAnotherRed);
+uint8_t SSD1680_FrameUnchanged(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode) {
+  const SSD1680_FingerprintTypeDef *fingerprint = hepd->Fingerprint;
+  const uint8_t unchanged = fingerprint && fingerprint->Magic == SSD1680_FINGERPRINT_MAGIC
+      && fingerprint->Hash == hepd->Frame_Hash && (fingerprint->Mode == mode || fingerprint->Mode == FullRefresh);
+  SSD1680_FrameBegin(hepd, 0);
+  return unchanged;
 }
 
 /**
- * @brief Update the display
- * @details Start update sequence to show internal memory content on the display.
+ * @brief Invert RAM bank content on refresh
+ * @details Controller inverts the bank while reading it for display update, RAM content stays intact.
+ * Takes effect on the next refresh. Costs a single command instead of rewriting the whole RAM bank.
  * @param[in] hepd: SSD1680 handle pointer
- * @param[in] mode: Refresh mode
+ * @param[in] bank: RAM bank to invert
+ * @param[in] enable: non-zero to invert, zero to restore normal
  * @return HAL status
- * @note Slow. Waits for display to complete operation.
  */
-HAL_StatusTypeDef SSD1680_Refresh(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode) {
-  HAL_StatusTypeDef status = HAL_OK;
-  const uint8_t boosterSoftStart[] = { 0x80, 0x90, 0x90, 0x00 };
-  if ((status = SSD1680_Send(hepd, SSD1680_BOOSTER_SOFT_START, boosterSoftStart, sizeof(boosterSoftStart))))    // 0x0C
-    return status;
-  if ((status = SSD1680_Send(hepd, SSD1680_UPDATE_CONTROL_2, &mode, sizeof(mode))))	// 0x22
-	  return status;
-  if ((status = SSD1680_Send(hepd, SSD1680_MASTER_ACTIVATION, 0, 0)))   // 0x20
-    return status;
-  SSD1680_Wait(hepd);
-  return status;
+HAL_StatusTypeDef SSD1680_Invert(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RAMBank bank, const uint8_t enable) {
+  if (enable)
+    hepd->Inverse |= 1 << bank;
+  else
+    hepd->Inverse &= ~(1 << bank);
+  return SSD1680_UpdateControl(hepd);
 }
 
 /**
@@ -404,23 +1991,46 @@ HAL_StatusTypeDef SSD1680_Border(SSD1680_HandleTypeDef *hepd, const enum SSD1680
  * @return HAL status
  */
 HAL_StatusTypeDef SSD1680_RAMReadOption(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RAMBank ram) {
-  return SSD1680_Send(hepd, SSD1680_RAM_READ_OPT, (uint8_t *)&ram, 1);
+  const uint8_t readOption = ram;
+  return SSD1680_Send(hepd, SSD1680_RAM_READ_OPT, &readOption, sizeof(readOption));  // 0x41
 }
 
 /**
  * @brief Read temperature
  * @details Reads temperature from internal sensor.
+ * The sensor register holds 12 bit two's complement value, MSB first.
+ * Earlier versions returned its two bytes swapped and shifted, callers decoding that must be updated.
  * @param[in] hepd: SSD1680 handle pointer
- * @return Temperature
+ * @return Temperature in 1/16 °C, 12 bit two's complement
+ * @note Value is not cached, refresh and @ref SSD1680_PredictRefresh keep using their own.
  * @note Return value is not surrounding air temperature but the temperature of display itself.
  * Pretty inaccurate relative to dedicated sensor chips.
  */
 uint16_t SSD1680_ReadTemp(SSD1680_HandleTypeDef *hepd) {
   const uint8_t tempSensor[] = { 0x80 };
   SSD1680_Send(hepd, SSD1680_SELECT_TEMP_SENSOR, tempSensor, sizeof(tempSensor));   // 0x18
-  uint16_t temp;
-  SSD1680_Receive(hepd, SSD1680_READ_TEMP, (uint8_t *)&temp, sizeof(temp));         // 0x1b
-  return temp >> 4;
+  uint8_t temp[2];
+  SSD1680_Receive(hepd, SSD1680_READ_TEMP, temp, sizeof(temp));         // 0x1b
+  return ((temp[0] << 8) | temp[1]) >> 4;
+}
+
+/**
+ * @brief Supply temperature from external sensor
+ * @details Switches refresh to use supplied temperature instead of internal sensor.
+ * LUT is reloaded on the next refresh if temperature drifted by more than @ref SSD1680_HandleTypeDef::Temp_Delta
+ * since the last load. Otherwise the loaded LUT is kept.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] temp: temperature in °C
+ */
+void SSD1680_SetTemp(SSD1680_HandleTypeDef *hepd, const int8_t temp) {
+  if (!hepd->Temp_External || !hepd->LUT_Valid || abs(temp - hepd->LUT_Temp) > hepd->Temp_Delta) {
+    hepd->LUT_Temp = temp;
+    hepd->LUT_Valid = 0;
+  }
+  hepd->Temp = temp;
+  hepd->Temp_Known = 1;
+  hepd->Temp_External = 1;
+  hepd->Temp_Time = HAL_GetTick();
 }
 
 
@@ -435,7 +2045,7 @@ uint16_t SSD1680_ReadTemp(SSD1680_HandleTypeDef *hepd) {
  */
 HAL_StatusTypeDef SSD1680_ResetRange(SSD1680_HandleTypeDef *hepd) {
   HAL_StatusTypeDef status = HAL_OK;
-  if ((status = SSD1680_RAMXRange(hepd, 0, hepd->Resolution_X / 8)))
+  if ((status = SSD1680_RAMXRange(hepd, 0, hepd->Resolution_X)))
     return status;
   if ((status = SSD1680_RAMYRange(hepd, 0, hepd->Resolution_Y)))
     return status;
@@ -453,14 +2063,165 @@ HAL_StatusTypeDef SSD1680_ResetRange(SSD1680_HandleTypeDef *hepd) {
  * @see SSD1680_SetRegion
  */
 HAL_StatusTypeDef SSD1680_StartAddress(SSD1680_HandleTypeDef *hepd, const uint8_t x, const uint16_t y) {
-  if (x % 8)
-    return HAL_ERROR;
   HAL_StatusTypeDef status = HAL_OK;
-  const uint8_t xaddr = x / 8;
-  if ((status = SSD1680_Send(hepd, SSD1680_RAM_X, &xaddr, sizeof(xaddr))))   // 0x4E
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_AddStartAddress(&tx, x, y)))
+    return status;
+  return SSD1680_TransactionCommit(&tx);
+}
+
+/**
+ * @brief Start bulk data transfer into RAM
+ * @details Sets RAM start address and sends write command for specified RAM bank.
+ * Leaves CS line asserted and !DC line high so that the data can be sent right away either by polling or by DMA.
+ * Not intended to use outside of SSD1680_SetRegion and SSD1680_SetRegion_DMA.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] left: leftmost column. Must be multiple of 8.
+ * @param[in] top: topmost row
+ * @param[in] ram: RAM bank
+ * @return HAL status
+ * @see SSD1680_EndTransfer
+ */
+HAL_StatusTypeDef SSD1680_BeginWrite(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const enum SSD1680_RAMBank ram) {
+  HAL_StatusTypeDef status = HAL_OK;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_AddStartAddress(&tx, left, top)))
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, ram == RAMRed ? SSD1680_WRITE_RED : SSD1680_WRITE_BLACK, NULL, 0)))  // 0x26 : 0x24
+    return status;
+  return SSD1680_TransactionSend(&tx, 1);
+}
+
+/**
+ * @brief Start bulk data transfer from RAM
+ * @details Sets RAM bank for read, RAM start address, sends read command and skips dummy bytes.
+ * Leaves CS line asserted and !DC line high so that the data can be received right away either by polling or by DMA.
+ * Not intended to use outside of SSD1680_GetRegion and SSD1680_GetRegion_DMA.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] left: leftmost column. Must be multiple of 8.
+ * @param[in] top: topmost row
+ * @param[in] ram: RAM bank
+ * @return HAL status
+ * @see SSD1680_EndTransfer
+ */
+HAL_StatusTypeDef SSD1680_BeginRead(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const enum SSD1680_RAMBank ram) {
+  HAL_StatusTypeDef status = HAL_OK;
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  const uint8_t readOption = ram;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_RAM_READ_OPT, &readOption, sizeof(readOption))))  // 0x41
+    return status;
+  if ((status = SSD1680_AddStartAddress(&tx, left, top)))
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, SSD1680_READ, NULL, 0)))  // 0x27
+    return status;
+  if ((status = SSD1680_TransactionSend(&tx, 1)))
+    return status;
+#if SSD1680_DUMMY_BYTES
+  // Reading dummy bytes
+  uint8_t dummy[SSD1680_DUMMY_BYTES];
+  status = SSD1680_SPI_Receive(hepd, dummy, sizeof(dummy));
+#endif // SSD1680_DUMMY_BYTES
+  return status;
+}
+
+/**
+ * @brief Finish bulk data transfer
+ * @details Releases CS line.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @see SSD1680_BeginRead
+ * @see SSD1680_BeginWrite
+ */
+void SSD1680_EndTransfer(SSD1680_HandleTypeDef *hepd) {
+  SSD1680_CS(hepd, GPIO_PIN_SET);
+  SSD1680_Activity(hepd, 0);
+}
+
+/**
+ * @brief Send rectangle of full screen image into display RAM
+ * @details Only the transfer of @ref SSD1680_WriteRect, the rectangle is neither hashed nor tracked.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] ram: RAM bank
+ * @param[in] image: full screen image of the bank, `Resolution_X / 8` bytes per row
+ * @param[in] box: byte aligned rectangle
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_SendRect(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RAMBank ram, const uint8_t *image, const SSD1680_BoxTypeDef *box) {
+  HAL_StatusTypeDef status = HAL_OK;
+  const uint8_t stride = hepd->Resolution_X / 8;
+  const uint8_t width = box->Right - box->Left;
+  const uint16_t height = box->Bottom - box->Top;
+  const uint8_t *data = image + box->Top * stride + box->Left / 8;
+  // Ranges, start address and write command under the single CS assertion SSD1680_FLUSH_OVERHEAD accounts for
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_AddRAMXRange(&tx, box->Left, width)))
+    return status;
+  if ((status = SSD1680_AddRAMYRange(&tx, box->Top, height)))
+    return status;
+  if ((status = SSD1680_AddStartAddress(&tx, box->Left, box->Top)))
+    return status;
+  if ((status = SSD1680_TransactionAdd(&tx, ram == RAMRed ? SSD1680_WRITE_RED : SSD1680_WRITE_BLACK, NULL, 0)))  // 0x26 : 0x24
+    return status;
+  if ((status = SSD1680_TransactionSend(&tx, 1)))
+    return status;
+  for (uint16_t y = 0; y < height && !status; ++y)
+    status = SSD1680_SPI_Transmit(hepd, data + y * stride, width / 8);
+  SSD1680_EndTransfer(hepd);
+  return status;
+}
+
+/**
+ * @brief Get framebuffer plane
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] plane: 0 for primary (black) plane, 1 for secondary (red) one
+ * @return Pointer to the first row of the plane
+ */
+static inline uint8_t *SSD1680_FramebufferPlane(SSD1680_HandleTypeDef *hepd, const uint8_t plane) {
+  return hepd->Framebuffer->Data + plane * (hepd->Resolution_X / 8) * hepd->Resolution_Y;
+}
+
+/**
+ * @brief Copy just displayed region from primary (black) to secondary (red) RAM bank
+ * @details Keeps previous image in secondary RAM bank for differential refresh of monochrome displays.
+ * Region is sent from the framebuffer if primary RAM bank holds only what @ref SSD1680_Flush uploaded there
+ * and none of the region rows was drawn since. Otherwise it is read back from the controller
+ * in chunks of @ref SSD1680_DIFF_CHUNK bytes. Either way it is written straight into secondary RAM bank,
+ * bypassing frame hash and dirty tracking.
+ * Must be done before primary RAM bank is changed again.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ * @see SSD1680_HandleTypeDef::Differential
+ */
+static HAL_StatusTypeDef SSD1680_CopyPrevious(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (!hepd->Copy_Pending)
     return status;
-  if ((status = SSD1680_Send(hepd, SSD1680_RAM_Y, (uint8_t *)&y, sizeof(y))))   // 0x4F
+  hepd->Copy_Pending = 0;
+  const SSD1680_BoxTypeDef box = hepd->Copy_Box;
+  const SSD1680_FramebufferTypeDef *fb = hepd->Framebuffer;
+  if (fb && !hepd->Framebuffer_Lost && !hepd->Diff_Direct
+      && (fb->Dirty_Bottom[0] <= fb->Dirty_Top[0] || fb->Dirty_Bottom[0] <= box.Top || fb->Dirty_Top[0] >= box.Bottom)) {
+    status = SSD1680_SendRect(hepd, RAMRed, SSD1680_FramebufferPlane(hepd, 0), &box);
+    hepd->Copy_Pending = status != HAL_OK;
     return status;
+  }
+  const uint8_t width = box.Right - box.Left;
+  uint8_t buffer[SSD1680_DIFF_CHUNK];
+  uint16_t rows = sizeof(buffer) / (width / 8);
+  for (uint16_t top = box.Top; top < box.Bottom && !status; top += rows) {
+    if (rows > box.Bottom - top)
+      rows = box.Bottom - top;
+    if ((status = SSD1680_GetRegion(hepd, box.Left, top, width, rows, buffer, NULL)))
+      break;
+    // Not SSD1680_SetRegion: the copy is not a frame write to be hashed or marked dirty
+    if (!(status = SSD1680_BeginWrite(hepd, box.Left, top, RAMRed)))
+      status = SSD1680_SPI_Transmit(hepd, buffer, width / 8 * rows);
+    SSD1680_EndTransfer(hepd);
+  }
+  hepd->Copy_Pending = status != HAL_OK;
   return status;
 }
 
@@ -480,6 +2241,7 @@ HAL_StatusTypeDef SSD1680_StartAddress(SSD1680_HandleTypeDef *hepd, const uint8_
  * Buffer must be at least `width / 8 * height` bytes.
  * @return HAL status
  * @see SSD1680_SetRegion
+ * @see SSD1680_GetRegion_DMA for non-blocking version
  */
 HAL_StatusTypeDef SSD1680_GetRegion(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, uint8_t *data_k, uint8_t *data_r) {
   HAL_StatusTypeDef status = HAL_OK;
@@ -488,48 +2250,339 @@ HAL_StatusTypeDef SSD1680_GetRegion(SSD1680_HandleTypeDef *hepd, const uint8_t l
   if ((status = SSD1680_RAMYRange(hepd, top, height)))
     return status;
 
-  if (data_k) {
-    if ((status = SSD1680_RAMReadOption(hepd, RAMBlack)))
-      return status;
-    if ((status = SSD1680_StartAddress(hepd, left, top)))
+  if (data_k) {
+    if (!(status = SSD1680_BeginRead(hepd, left, top, RAMBlack)))
+      status = SSD1680_SPI_Receive(hepd, data_k, width / 8 * height);
+    SSD1680_EndTransfer(hepd);
+    if (status)
+      return status;
+  }
+  if (data_r) {
+    if (!(status = SSD1680_BeginRead(hepd, left, top, RAMRed)))
+      status = SSD1680_SPI_Receive(hepd, data_r, width / 8 * height);
+    SSD1680_EndTransfer(hepd);
+  }
+  return status;
+}
+
+/**
+ * @brief Bulk write data to RAM
+ * @details Writes data to RAM region with specified location and dimensions.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] left: leftmost column. Must be multiple of 8.
+ * @param[in] top: topmost row
+ * @param[in] width: region width. Must be multiple of 8.
+ * @param[in] height: region height.
+ * @param[in] data_k: pointer to buffer where data for primary (black) RAM bank is stored.
+ * Buffer must be at least `width / 8 * height` bytes.
+ * Set to NULL to skip updating primary RAM bank.
+ * @param[in] data_r: pointer to buffer where data for secondary (red) RAM bank is stored.
+ * Buffer must be at least `width / 8 * height` bytes.
+ * Set to NULL to skip updating secondary RAM bank.
+ * @return HAL status
+ * @see SSD1680_GetRegion
+ * @see SSD1680_SetRegion_DMA for non-blocking version
+ */
+HAL_StatusTypeDef SSD1680_SetRegion(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r) {
+  HAL_StatusTypeDef status = HAL_OK;
+  SSD1680_HashRegion(hepd, left, top, width, height, data_k, data_r, width / 8);
+  if (hepd->Frame_Dry)
+    return status;
+  if (data_k) {
+    if ((status = SSD1680_CopyPrevious(hepd)))
+      return status;
+    SSD1680_MarkDirty(hepd, left, top, width, height);
+  }
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(hepd, &tx);
+  if ((status = SSD1680_AddRAMXRange(&tx, left, width)))
+    return status;
+  if ((status = SSD1680_AddRAMYRange(&tx, top, height)))
+    return status;
+
+  if (data_k) {
+    if ((status = SSD1680_AddStartAddress(&tx, left, top)))
+      return status;
+    if ((status = SSD1680_TransactionAdd(&tx, SSD1680_WRITE_BLACK, data_k, width / 8 * height))) // 0x24
+      return status;
+  }
+  if (data_r) {
+    if ((status = SSD1680_AddStartAddress(&tx, left, top)))
+      return status;
+    if ((status = SSD1680_TransactionAdd(&tx, SSD1680_WRITE_RED, data_r, width / 8 * height))) // 0x26
+      return status;
+  }
+  return SSD1680_TransactionCommit(&tx);
+}
+
+/**
+ * @brief Get cost of rectangle upload
+ * @param[in] overhead: cost of starting upload in bytes of payload
+ * @param[in] box: byte aligned rectangle
+ * @return Cost in bytes of payload
+ */
+static inline int32_t SSD1680_PlanCost(const int32_t overhead, const SSD1680_BoxTypeDef *box) {
+  return overhead + (box->Right - box->Left) / 8 * (box->Bottom - box->Top);
+}
+
+/**
+ * @brief Plan upload of screen regions
+ * @details Aligns rectangles to bytes, drops empty ones and merges pairs of rectangles into bounding boxes
+ * while it is cheaper to resend unchanged bytes than to start one more upload.
+ * Every step merges the pair saving most.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in,out] boxes: rectangles to upload. Replaced with the plan.
+ * @param[in] count: number of rectangles
+ * @return Number of rectangles in the plan
+ * @see SSD1680_HandleTypeDef::Flush_Overhead
+ */
+uint8_t SSD1680_PlanRegions(SSD1680_HandleTypeDef *hepd, SSD1680_BoxTypeDef *boxes, const uint8_t count) {
+  const int32_t overhead = hepd->Flush_Overhead ? hepd->Flush_Overhead : SSD1680_FLUSH_OVERHEAD;
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    SSD1680_BoxTypeDef box = boxes[i];
+    const uint16_t right = (box.Right + 7) & ~7;
+    box.Right = right < hepd->Resolution_X ? right : hepd->Resolution_X;
+    box.Left &= ~7;
+    if (box.Bottom > hepd->Resolution_Y)
+      box.Bottom = hepd->Resolution_Y;
+    if (box.Right > box.Left && box.Bottom > box.Top)
+      boxes[n++] = box;
+  }
+  for (;;) {
+    int32_t best = 0;
+    uint8_t bestI = 0;
+    uint8_t bestJ = 0;
+    SSD1680_BoxTypeDef merged = { 0 };
+    for (uint8_t i = 0; i < n; ++i) {
+      for (uint8_t j = i + 1; j < n; ++j) {
+        const SSD1680_BoxTypeDef box = {
+          boxes[i].Left < boxes[j].Left ? boxes[i].Left : boxes[j].Left,
+          boxes[i].Right > boxes[j].Right ? boxes[i].Right : boxes[j].Right,
+          boxes[i].Top < boxes[j].Top ? boxes[i].Top : boxes[j].Top,
+          boxes[i].Bottom > boxes[j].Bottom ? boxes[i].Bottom : boxes[j].Bottom
+        };
+        const int32_t saving = SSD1680_PlanCost(overhead, &boxes[i]) + SSD1680_PlanCost(overhead, &boxes[j]) - SSD1680_PlanCost(overhead, &box);
+        if (saving > best) {
+          best = saving;
+          bestI = i;
+          bestJ = j;
+          merged = box;
+        }
+      }
+    }
+    if (!best)
+      return n;
+    boxes[bestI] = merged;
+    boxes[bestJ] = boxes[--n];
+  }
+}
+
+/**
+ * @brief Upload rectangle of full screen image into display RAM
+ * @details Rows are sent right from the image under a single write command. Hashed the same way as @ref SSD1680_SetRegion.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] ram: RAM bank
+ * @param[in] image: full screen image of the bank, `Resolution_X / 8` bytes per row
+ * @param[in] box: byte aligned rectangle
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_WriteRect(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RAMBank ram, const uint8_t *image, const SSD1680_BoxTypeDef *box) {
+  HAL_StatusTypeDef status = HAL_OK;
+  const uint8_t stride = hepd->Resolution_X / 8;
+  const uint8_t width = box->Right - box->Left;
+  const uint16_t height = box->Bottom - box->Top;
+  const uint8_t *data = image + box->Top * stride + box->Left / 8;
+  SSD1680_HashRegion(hepd, box->Left, box->Top, width, height, ram == RAMBlack ? data : NULL, ram == RAMRed ? data : NULL, stride);
+  if (hepd->Frame_Dry)
+    return status;
+  if (ram == RAMBlack) {
+    if ((status = SSD1680_CopyPrevious(hepd)))
+      return status;
+    SSD1680_MarkDirty(hepd, box->Left, box->Top, width, height);
+  }
+  return SSD1680_SendRect(hepd, ram, image, box);
+}
+
+/**
+ * @brief Write several regions of the screen at once
+ * @details Takes regions of full screen images and uploads them as planned by @ref SSD1680_PlanRegions.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] boxes: regions to write
+ * @param[in] count: number of regions. Must not exceed @ref SSD1680_PLAN_BOXES.
+ * @param[in] image_k: full screen image for primary (black) RAM bank, `Resolution_X / 8` bytes per row. Set to NULL to skip updating primary RAM bank.
+ * @param[in] image_r: full screen image for secondary (red) RAM bank, `Resolution_X / 8` bytes per row. Set to NULL to skip updating secondary RAM bank.
+ * @return HAL status
+ * @retval HAL_ERROR if there are too many regions
+ * @see SSD1680_SetRegion
+ */
+HAL_StatusTypeDef SSD1680_SetRegions(SSD1680_HandleTypeDef *hepd, const SSD1680_BoxTypeDef *boxes, const uint8_t count, const uint8_t *image_k, const uint8_t *image_r) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (count > SSD1680_PLAN_BOXES)
+    return HAL_ERROR;
+  SSD1680_BoxTypeDef plan[SSD1680_PLAN_BOXES];
+  memcpy(plan, boxes, count * sizeof(*boxes));
+  const uint8_t n = SSD1680_PlanRegions(hepd, plan, count);
+  for (uint8_t i = 0; i < n && !status; ++i) {
+    if (image_k)
+      status = SSD1680_WriteRect(hepd, RAMBlack, image_k, &plan[i]);
+    if (image_r && !status)
+      status = SSD1680_WriteRect(hepd, RAMRed, image_r, &plan[i]);
+  }
+  return status;
+}
+
+/**
+ * @brief Get driver state
+ * @details Samples BUSY line if the display is busy and BUSY EXTI is not used.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return Driver state
+ * @see SSD1680_SetRegion_DMA
+ * @see SSD1680_GetRegion_DMA
+ * @see SSD1680_Refresh_IT
+ */
+enum SSD1680_State SSD1680_GetState(SSD1680_HandleTypeDef *hepd) {
+  if (hepd->State == StateBusy && !hepd->BUSY_EXTI
+      && HAL_GPIO_ReadPin(hepd->BUSY_Port, hepd->BUSY_Pin) == GPIO_PIN_RESET)
+    SSD1680_BusyDone(hepd);
+  return hepd->State;
+}
+
+/**
+ * @brief Do background housekeeping
+ * @details Call periodically from the main loop. Never waits for the display.
+ * Neither cleans nor powers down while a requested refresh is pending.
+ * @li Keeps previous image for differential refresh. @see SSD1680_HandleTypeDef::Differential
+ * @li Restores full screen gate scan range after refresh of a band of rows. @see SSD1680_RefreshRegion_IT
+ * @li Starts requested refresh when due. @see SSD1680_RequestRefresh
+ * @li Cleans overworked band of rows after @ref SSD1680_HandleTypeDef::Clean_Idle ms of quiet
+ * @li Disables analog and clock after @ref SSD1680_HandleTypeDef::Burst_Idle ms of quiet
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ */
+HAL_StatusTypeDef SSD1680_Process(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (hepd->Sleep || SSD1680_GetState(hepd) != StateReady)
+    return status;
+  if ((status = SSD1680_CopyPrevious(hepd)))
+    return status;
+  if ((status = SSD1680_RestoreGateScan(hepd)))
+    return status;
+  if (hepd->Sched_Pending) {
+    // Requested refresh is still coming, cleaning or powering down now would be undone by it
+    const uint32_t now = HAL_GetTick();
+    if (hepd->Sched_Urgent || now - hepd->Sched_Last >= hepd->Debounce
+        || (hepd->Deadline && now - hepd->Sched_First >= hepd->Deadline))
+      return SSD1680_Dispatch(hepd);
+    return status;
+  }
+  if (hepd->Ghost && hepd->Ghost_Clean && HAL_GetTick() - (hepd->Busy_Start + hepd->Busy_Duration) >= hepd->Clean_Idle) {
+    if ((status = SSD1680_Clean(hepd)) || SSD1680_GetState(hepd) != StateReady)
+      return status;
+  }
+  if (hepd->Analog_On && HAL_GetTick() - (hepd->Busy_Start + hepd->Busy_Duration) >= hepd->Burst_Idle)
+    status = SSD1680_PowerDown(hepd);
+  return status;
+}
+
+/**
+ * @brief Get refresh scheduler statistics
+ * @details Requests minus refreshes is the number of refreshes saved by merging.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[out] stats: statistics
+ * @see SSD1680_RequestRefresh
+ */
+void SSD1680_GetSchedulerStats(SSD1680_HandleTypeDef *hepd, SSD1680_SchedulerStatsTypeDef *stats) {
+  *stats = hepd->Sched_Stats;
+}
+
+/**
+ * @brief Get energy governor statistics
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[out] stats: statistics
+ * @see SSD1680_HandleTypeDef::Energy_Model
+ * @see SSD1680_EnergyRemaining
+ */
+void SSD1680_GetGovernorStats(SSD1680_HandleTypeDef *hepd, SSD1680_GovernorStatsTypeDef *stats) {
+  *stats = hepd->Governor_Stats;
+}
+
+/**
+ * @brief Finish asynchronous operation
+ * @details Returns driver into ready state and notifies the caller via @ref SSD1680_HandleTypeDef::Transfer_Callback
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] status: status of the operation
+ */
+static void SSD1680_TransferDone(SSD1680_HandleTypeDef *hepd, HAL_StatusTypeDef status) {
+  hepd->DMA_Data = NULL;
+  hepd->DMA_Chain_Size = 0;
+  if (status) {
+    hepd->DMA_Status = status;
+    SSD1680_InvalidateShadow(hepd);
+  }
+  hepd->State = StateReady;
+  if (hepd->Transfer_Callback)
+    hepd->Transfer_Callback(hepd, status);
+}
+
+/**
+ * @brief Non-blocking bulk read data from RAM
+ * @details Reads data from RAM region with specified location and dimensions using SPI DMA.
+ * Address setup is sent by polling, the data itself is received by DMA.
+ * Returns right after the first DMA transfer is started.
+ * Completion is reported via @ref SSD1680_HandleTypeDef::Transfer_Callback and by SSD1680_GetState returning @ref StateReady.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] left: leftmost column. Must be multiple of 8.
+ * @param[in] top: topmost row
+ * @param[in] width: region width. Must be multiple of 8.
+ * @param[in] height: region height.
+ * @param[out] data_k: pointer to buffer where to store data from primary (black) RAM bank.
+ * Buffer must be at least `width / 8 * height` bytes.
+ * Set to NULL to skip reading from primary RAM bank.
+ * @param[out] data_r: pointer to buffer where to store data from secondary (red) RAM bank.
+ * Buffer must be at least `width / 8 * height` bytes.
+ * Set to NULL to skip reading from secondary RAM bank.
+ * @return HAL status
+ * @retval HAL_BUSY if another asynchronous transfer is in progress
+ * @note Buffers must stay valid until the transfer is complete.
+ * @note SSD1680_SPI_CpltCallback must be called from `HAL_SPI_RxCpltCallback`.
+ * @see SSD1680_GetRegion for blocking version
+ */
+HAL_StatusTypeDef SSD1680_GetRegion_DMA(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, uint8_t *data_k, uint8_t *data_r) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if ((status = SSD1680_Acquire(hepd)))
+    return status;
+  if ((status = SSD1680_RAMXRange(hepd, left, width)))
+    return status;
+  if ((status = SSD1680_RAMYRange(hepd, top, height)))
+    return status;
+  if (!data_k && !data_r)
+    return status;
+
+  hepd->DMA_Left = left;
+  hepd->DMA_Top = top;
+  // Failure of an earlier transfer nobody waited for is not this one's
+  hepd->DMA_Status = HAL_OK;
+  hepd->DMA_Size = width / 8 * height;
+  hepd->DMA_Data = data_k ? data_r : NULL;
+  if (!(status = SSD1680_BeginRead(hepd, left, top, data_k ? RAMBlack : RAMRed))) {
+    hepd->State = StateReceive;
+    if (!(status = SSD1680_SPI_Receive_DMA(hepd, data_k ? data_k : data_r, hepd->DMA_Size)))
       return status;
-    // Sending Read RAM command
-    HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_RESET);
-    uint8_t cmd = SSD1680_READ;
-#if defined(DEBUG)
-    if (hepd->LED_Port)
-      HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_RESET);
-#endif // DEBUG
-    if ((status = HAL_SPI_Transmit(hepd->SPI_Handle, &cmd, 1, hepd->SPI_Timeout))) {
-      HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_SET);
-      goto exit_GetRegion;
-    }
-    HAL_GPIO_WritePin(hepd->DC_Port, hepd->DC_Pin, GPIO_PIN_SET);
-    // Reading data
-    uint8_t *pData = data_k;
-#define SSD1680_DUMMY_BYTES 2
-#if SSD1680_DUMMY_BYTES
-      // Reading dummy bytes
-      if ((status = HAL_SPI_Receive(hepd->SPI_Handle, pData, SSD1680_DUMMY_BYTES, hepd->SPI_Timeout)))
-        goto exit_GetRegion;
-#endif // SSD1680_DUMMY_BYTES
-      if ((status = HAL_SPI_Receive(hepd->SPI_Handle, pData, width / 8 * height, hepd->SPI_Timeout)))
-        goto exit_GetRegion;
   }
-exit_GetRegion:
-  HAL_GPIO_WritePin(hepd->CS_Port, hepd->CS_Pin, GPIO_PIN_SET);
-#if defined(DEBUG)
-  if (hepd->LED_Port)
-    HAL_GPIO_WritePin(hepd->LED_Port, hepd->LED_Pin, GPIO_PIN_SET);
-#endif // DEBUG
+  SSD1680_EndTransfer(hepd);
+  hepd->DMA_Data = NULL;
+  hepd->State = StateReady;
   return status;
-
 }
 
 /**
- * @brief Bulk write data to RAM
- * @details Writes data to RAM region with specified location and dimensions.
+ * @brief Non-blocking bulk write data to RAM
+ * @details Writes data to RAM region with specified location and dimensions using SPI DMA.
+ * Address setup is sent by polling, the data itself is transmitted by DMA.
+ * Returns right after the first DMA transfer is started.
+ * Completion is reported via @ref SSD1680_HandleTypeDef::Transfer_Callback and by SSD1680_GetState returning @ref StateReady.
+ * In dry run the region is only hashed and completion is reported before return. @see SSD1680_FrameBegin
  * @param[in] hepd: SSD1680 handle pointer
  * @param[in] left: leftmost column. Must be multiple of 8.
  * @param[in] top: topmost row
@@ -542,30 +2595,165 @@ exit_GetRegion:
  * Buffer must be at least `width / 8 * height` bytes.
  * Set to NULL to skip updating secondary RAM bank.
  * @return HAL status
- * @see SSD1680_GetRegion
+ * @retval HAL_BUSY if another asynchronous transfer is in progress
+ * @note Buffers must stay valid until the transfer is complete.
+ * @note SSD1680_SPI_CpltCallback must be called from `HAL_SPI_TxCpltCallback`.
+ * @see SSD1680_SetRegion for blocking version
  */
-HAL_StatusTypeDef SSD1680_SetRegion(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r) {
+HAL_StatusTypeDef SSD1680_SetRegion_DMA(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r) {
   HAL_StatusTypeDef status = HAL_OK;
-  if ((status = SSD1680_RAMXRange(hepd, left, width)))
+  if (hepd->Frame_Dry) {
+    // Nothing is sent, the transfer is complete right away
+    SSD1680_HashRegion(hepd, left, top, width, height, data_k, data_r, width / 8);
+    if (hepd->Transfer_Callback)
+      hepd->Transfer_Callback(hepd, status);
     return status;
-  if ((status = SSD1680_RAMYRange(hepd, top, height)))
+  }
+  if ((status = SSD1680_Acquire(hepd)))
     return status;
-
+  SSD1680_HashRegion(hepd, left, top, width, height, data_k, data_r, width / 8);
   if (data_k) {
-    if ((status = SSD1680_StartAddress(hepd, left, top)))
-      return status;
-    if ((status = SSD1680_Send(hepd, SSD1680_WRITE_BLACK, data_k, width / 8 * height))) // 0x24
+    if ((status = SSD1680_CopyPrevious(hepd)))
       return status;
+    SSD1680_MarkDirty(hepd, left, top, width, height);
   }
-  if (data_r) {
-    if ((status = SSD1680_StartAddress(hepd, left, top)))
-      return status;
-    if ((status = SSD1680_Send(hepd, SSD1680_WRITE_RED, data_r, width / 8 * height))) // 0x26
+  if ((status = SSD1680_RAMXRange(hepd, left, width)))
+    return status;
+  if ((status = SSD1680_RAMYRange(hepd, top, height)))
+    return status;
+  if (!data_k && !data_r)
+    return status;
+
+  hepd->DMA_Left = left;
+  hepd->DMA_Top = top;
+  // Failure of an earlier transfer nobody waited for is not this one's
+  hepd->DMA_Status = HAL_OK;
+  hepd->DMA_Size = width / 8 * height;
+  hepd->DMA_Data = data_k ? (uint8_t *)data_r : NULL;
+  if (!(status = SSD1680_BeginWrite(hepd, left, top, data_k ? RAMBlack : RAMRed))) {
+    hepd->State = StateTransmit;
+    if (!(status = SSD1680_SPI_Transmit_DMA(hepd, data_k ? data_k : data_r, hepd->DMA_Size)))
       return status;
   }
+  SSD1680_EndTransfer(hepd);
+  hepd->DMA_Data = NULL;
+  hepd->State = StateReady;
   return status;
 }
 
+/**
+ * @brief Prepare commands ahead of secondary (red) RAM bank DMA transfer
+ * @details Same commands SSD1680_BeginRead and SSD1680_BeginWrite send, but stored in the handle to be sent by DMA.
+ * Shadow copy is not consulted as the chain runs in interrupt context.
+ * @param[in] hepd: SSD1680 handle pointer
+ */
+static void SSD1680_ChainBegin(SSD1680_HandleTypeDef *hepd) {
+  uint8_t *p = hepd->DMA_Chain;
+  if (hepd->State == StateReceive) {
+    *p++ = SSD1680_RAM_READ_OPT;  // 0x41
+    *p++ = 1;
+    *p++ = RAMRed;
+  }
+  *p++ = SSD1680_RAM_X;  // 0x4E
+  *p++ = 1;
+  *p++ = hepd->DMA_Left / 8;
+  *p++ = SSD1680_RAM_Y;  // 0x4F
+  *p++ = sizeof(hepd->DMA_Top);
+  memcpy(p, &hepd->DMA_Top, sizeof(hepd->DMA_Top));
+  p += sizeof(hepd->DMA_Top);
+  *p++ = hepd->State == StateReceive ? SSD1680_READ : SSD1680_WRITE_RED;  // 0x27 or 0x26
+  *p++ = 0;
+  hepd->DMA_Chain_Size = p - hepd->DMA_Chain;
+  hepd->DMA_Chain_Pos = 0;
+  hepd->DMA_Chain_Phase = 0;
+}
+
+/**
+ * @brief Start next DMA stage of secondary (red) RAM bank transfer
+ * @details Sends prepared commands byte by byte toggling !DC line in between, skips dummy bytes on read
+ * and finally starts the data transfer itself.
+ * Never polls SPI nor waits for the display so it is safe to call from SSD1680_SPI_CpltCallback.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status
+ */
+static HAL_StatusTypeDef SSD1680_ChainStep(SSD1680_HandleTypeDef *hepd) {
+  const uint8_t receive = hepd->State == StateReceive;
+  while (hepd->DMA_Chain_Pos < hepd->DMA_Chain_Size) {
+    const uint8_t *command = hepd->DMA_Chain + hepd->DMA_Chain_Pos;
+    const uint8_t size = command[1];
+    switch (hepd->DMA_Chain_Phase++) {
+      case 0:
+        SSD1680_STAT(hepd, Commands, 1);
+        SSD1680_DC(hepd, GPIO_PIN_RESET);
+        return SSD1680_SPI_Transmit_DMA(hepd, command, 1);
+      case 1:
+        SSD1680_DC(hepd, GPIO_PIN_SET);
+        if (size)
+          return SSD1680_SPI_Transmit_DMA(hepd, command + 2, size);
+        break;
+      default:
+        SSD1680_ShadowUpdate(hepd, command[0], command + 2, size);
+        hepd->DMA_Chain_Pos += 2 + size;
+        hepd->DMA_Chain_Phase = 0;
+    }
+  }
+#if SSD1680_DUMMY_BYTES
+  if (receive && !hepd->DMA_Chain_Phase++)
+    return SSD1680_SPI_Receive_DMA(hepd, hepd->DMA_Chain, SSD1680_DUMMY_BYTES);
+#endif // SSD1680_DUMMY_BYTES
+  uint8_t *pData = hepd->DMA_Data;
+  hepd->DMA_Data = NULL;
+  hepd->DMA_Chain_Size = 0;
+  if (receive)
+    return SSD1680_SPI_Receive_DMA(hepd, pData, hepd->DMA_Size);
+  return SSD1680_SPI_Transmit_DMA(hepd, pData, hepd->DMA_Size);
+}
+
+/**
+ * @brief SPI DMA transfer complete handler
+ * @details Releases CS line and either starts transfer of secondary (red) RAM bank or finishes the operation.
+ * Commands ahead of secondary RAM bank data are sent as DMA stages of their own, so the handler never blocks.
+ * Call it from `HAL_SPI_TxCpltCallback` and `HAL_SPI_RxCpltCallback`.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] hspi: SPI handle the callback was called for. Ignored if doesn't match the one of SSD1680 handle.
+ * @see SSD1680_SetRegion_DMA
+ * @see SSD1680_GetRegion_DMA
+ */
+void SSD1680_SPI_CpltCallback(SSD1680_HandleTypeDef *hepd, SPI_HandleTypeDef *hspi) {
+  if (hspi != hepd->SPI_Handle || (hepd->State != StateTransmit && hepd->State != StateReceive))
+    return;
+  if (!hepd->DMA_Chain_Size) {
+    SSD1680_EndTransfer(hepd);
+    if (!hepd->DMA_Data) {
+      SSD1680_TransferDone(hepd, HAL_OK);
+      return;
+    }
+    // Secondary (red) RAM bank is pending
+    SSD1680_ChainBegin(hepd);
+    SSD1680_Activity(hepd, 1);
+    SSD1680_CS(hepd, GPIO_PIN_RESET);
+  }
+  HAL_StatusTypeDef status = HAL_OK;
+  if (!(status = SSD1680_ChainStep(hepd)))
+    return;
+  SSD1680_EndTransfer(hepd);
+  SSD1680_TransferDone(hepd, status);
+}
+
+/**
+ * @brief SPI DMA transfer error handler
+ * @details Releases CS line and finishes the operation with error.
+ * Call it from `HAL_SPI_ErrorCallback`.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] hspi: SPI handle the callback was called for. Ignored if doesn't match the one of SSD1680 handle.
+ */
+void SSD1680_SPI_ErrorCallback(SSD1680_HandleTypeDef *hepd, SPI_HandleTypeDef *hspi) {
+  if (hspi != hepd->SPI_Handle || (hepd->State != StateTransmit && hepd->State != StateReceive))
+    return;
+  SSD1680_EndTransfer(hepd);
+  SSD1680_TransferDone(hepd, HAL_ERROR);
+}
+
 /**
  * @brief Put a text a screen horizontally
  * @details Prints a string at specified position with specified font.
@@ -675,6 +2863,731 @@ HAL_StatusTypeDef SSD1680_VerticalText(SSD1680_HandleTypeDef *hepd, const uint8_
   return HAL_OK;
 }
 
+/**
+ * @brief Mark framebuffer rectangle dirty
+ * @details Extends the last dirty rectangle of the plane if the change continues it, as consecutive rows
+ * of the same change do, or adds a new one. When the list is full the change is merged into the rectangle growing least.
+ * Takes constant time whatever the height of the change.
+ * @param[in] fb: framebuffer pointer
+ * @param[in] plane: 0 for primary (black) plane, 1 for secondary (red) one
+ * @param[in] left: leftmost dirty byte column
+ * @param[in] right: rightmost dirty byte column
+ * @param[in] top: topmost dirty row
+ * @param[in] bottom: row next to the bottommost dirty one
+ */
+static void SSD1680_FramebufferMark(SSD1680_FramebufferTypeDef *fb, const uint8_t plane, const uint8_t left, const uint8_t right, const uint16_t top, const uint16_t bottom) {
+  const SSD1680_BoxTypeDef box = { left * 8, (right + 1) * 8, top, bottom };
+  SSD1680_BoxTypeDef *boxes = fb->Dirty[plane];
+  uint8_t count = fb->Dirty_Count[plane];
+  SSD1680_BoxTypeDef *target = NULL;
+  // Vertically adjacent or overlapping with overlapping spans continues the last rectangle
+  if (count && boxes[count - 1].Top <= box.Bottom && boxes[count - 1].Bottom >= box.Top
+      && boxes[count - 1].Left < box.Right && boxes[count - 1].Right > box.Left) {
+    target = &boxes[count - 1];
+  } else if (count < SSD1680_FB_RECTS) {
+    boxes[count] = box;
+    fb->Dirty_Count[plane] = count + 1;
+  } else {
+    uint32_t best = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < count; ++i) {
+      const uint32_t growth = (uint32_t)((boxes[i].Right > box.Right ? boxes[i].Right : box.Right) - (boxes[i].Left < box.Left ? boxes[i].Left : box.Left))
+          * ((boxes[i].Bottom > box.Bottom ? boxes[i].Bottom : box.Bottom) - (boxes[i].Top < box.Top ? boxes[i].Top : box.Top))
+          - (uint32_t)(boxes[i].Right - boxes[i].Left) * (boxes[i].Bottom - boxes[i].Top);
+      if (growth < best) {
+        best = growth;
+        target = &boxes[i];
+      }
+    }
+  }
+  if (target) {
+    if (box.Left < target->Left)
+      target->Left = box.Left;
+    if (box.Right > target->Right)
+      target->Right = box.Right;
+    if (box.Top < target->Top)
+      target->Top = box.Top;
+    if (box.Bottom > target->Bottom)
+      target->Bottom = box.Bottom;
+  }
+  if (fb->Dirty_Bottom[plane] <= fb->Dirty_Top[plane]) {
+    fb->Dirty_Top[plane] = top;
+    fb->Dirty_Bottom[plane] = bottom;
+    return;
+  }
+  if (top < fb->Dirty_Top[plane])
+    fb->Dirty_Top[plane] = top;
+  if (bottom > fb->Dirty_Bottom[plane])
+    fb->Dirty_Bottom[plane] = bottom;
+}
+
+/**
+ * @brief Fill rectangle of plane rows
+ * @param[in] row: the first row of the rectangle
+ * @param[in] stride: row size in bytes
+ * @param[in] height: number of rows
+ * @param[in] left: leftmost column
+ * @param[in] width: rectangle width
+ * @param[in] bit: bit value to fill with
+ */
+static void SSD1680_FillRows(uint8_t *row, const uint8_t stride, const uint16_t height, const uint8_t left, const uint8_t width, const uint8_t bit) {
+  const uint8_t fill = bit ? 0xFF : 0x00;
+  const uint8_t first = left / 8;
+  const uint8_t last = (left + width - 1) / 8;
+  const uint8_t firstMask = 0xFF >> (left & 7);
+  const uint8_t lastMask = 0xFF << (7 - ((left + width - 1) & 7));
+  for (uint16_t y = 0; y < height; ++y, row += stride) {
+    for (uint8_t x = first; x <= last; ++x) {
+      uint8_t mask = 0xFF;
+      if (x == first)
+        mask &= firstMask;
+      if (x == last)
+        mask &= lastMask;
+      row[x] = (row[x] & ~mask) | (fill & mask);
+    }
+  }
+}
+
+/**
+ * @brief Draw a pixel into framebuffer
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] x: column
+ * @param[in] y: row
+ * @param[in] color: pixel color
+ * @return HAL status
+ * @retval HAL_ERROR if there is no framebuffer or the pixel is off the screen
+ * @see SSD1680_Flush
+ */
+HAL_StatusTypeDef SSD1680_DrawPixel(SSD1680_HandleTypeDef *hepd, const uint8_t x, const uint16_t y, const enum SSD1680_Color color) {
+  return SSD1680_DrawRect(hepd, x, y, 1, 1, color);
+}
+
+/**
+ * @brief Draw filled rectangle into framebuffer
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] left: leftmost column
+ * @param[in] top: topmost row
+ * @param[in] width: rectangle width
+ * @param[in] height: rectangle height
+ * @param[in] color: fill color
+ * @return HAL status
+ * @retval HAL_ERROR if there is no framebuffer or the rectangle is empty or doesn't fit the screen
+ * @see SSD1680_Flush
+ */
+HAL_StatusTypeDef SSD1680_DrawRect(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const enum SSD1680_Color color) {
+  SSD1680_FramebufferTypeDef *fb = hepd->Framebuffer;
+  if (!fb || !width || !height || left + width > hepd->Resolution_X || top + height > hepd->Resolution_Y)
+    return HAL_ERROR;
+  const uint8_t stride = hepd->Resolution_X / 8;
+  for (uint8_t plane = 0; plane < hepd->Color_Depth; ++plane) {
+    SSD1680_FillRows(SSD1680_FramebufferPlane(hepd, plane) + top * stride, stride, height, left, width, (color >> plane) & 1);
+    SSD1680_FramebufferMark(fb, plane, left / 8, (left + width - 1) / 8, top, top + height);
+  }
+  return HAL_OK;
+}
+
+/**
+ * @brief Draw image into framebuffer
+ * @details Takes the same data as @ref SSD1680_SetRegion.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] left: leftmost column. Must be multiple of 8.
+ * @param[in] top: topmost row
+ * @param[in] width: region width. Must be multiple of 8.
+ * @param[in] height: region height
+ * @param[in] data_k: pointer to `width / 8 * height` bytes of primary (black) plane or NULL to keep it
+ * @param[in] data_r: pointer to `width / 8 * height` bytes of secondary (red) plane or NULL to keep it. Ignored for 1 bit color depth.
+ * @return HAL status
+ * @retval HAL_ERROR if there is no framebuffer or the region is empty or doesn't fit the screen
+ * @see SSD1680_Flush
+ */
+HAL_StatusTypeDef SSD1680_DrawRegion(SSD1680_HandleTypeDef *hepd, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r) {
+  SSD1680_FramebufferTypeDef *fb = hepd->Framebuffer;
+  if (!fb || !width || !height || left + width > hepd->Resolution_X || top + height > hepd->Resolution_Y)
+    return HAL_ERROR;
+  const uint8_t stride = hepd->Resolution_X / 8;
+  const uint8_t *data[] = { data_k, data_r };
+  for (uint8_t plane = 0; plane < hepd->Color_Depth; ++plane) {
+    if (!data[plane])
+      continue;
+    uint8_t *row = SSD1680_FramebufferPlane(hepd, plane) + top * stride + left / 8;
+    for (uint16_t y = 0; y < height; ++y, row += stride)
+      memcpy(row, data[plane] + y * (width / 8), width / 8);
+    SSD1680_FramebufferMark(fb, plane, left / 8, (left + width) / 8 - 1, top, top + height);
+  }
+  return HAL_OK;
+}
+
+/**
+ * @brief Load 4 bytes as a word
+ * @param[in] pData: pointer to the bytes. Needs no alignment.
+ * @return Word
+ */
+static inline uint32_t SSD1680_Word(const uint8_t *pData) {
+  uint32_t word;
+  memcpy(&word, pData, sizeof(word));
+  return word;
+}
+
+/**
+ * @brief Get offset of the first nonzero byte of a word in memory order
+ * @param[in] word: nonzero word loaded with @ref SSD1680_Word
+ * @return Byte offset, 0 to 3
+ */
+static inline uint8_t SSD1680_FirstByte(const uint32_t word) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return __builtin_clz(word) >> 3;
+#else
+  return __builtin_ctz(word) >> 3;
+#endif // __BYTE_ORDER__
+}
+
+/**
+ * @brief Get offset of the last nonzero byte of a word in memory order
+ * @param[in] word: nonzero word loaded with @ref SSD1680_Word
+ * @return Byte offset, 0 to 3
+ */
+static inline uint8_t SSD1680_LastByte(const uint32_t word) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return 3 - (__builtin_ctz(word) >> 3);
+#else
+  return 3 - (__builtin_clz(word) >> 3);
+#endif // __BYTE_ORDER__
+}
+
+/**
+ * @brief Find the first differing byte
+ * @details XORs word at a time and locates the byte within the first nonzero word by counting zero bits.
+ * Tail shorter than a word is compared as the last word of the row.
+ * @param[in] a: first row
+ * @param[in] b: second row
+ * @param[in] size: row size
+ * @return Index of the first differing byte or size if rows are equal
+ */
+static uint8_t SSD1680_DiffFirst(const uint8_t *a, const uint8_t *b, const uint8_t size) {
+  uint32_t diff;
+  uint8_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    if ((diff = SSD1680_Word(a + i) ^ SSD1680_Word(b + i)))
+      return i + SSD1680_FirstByte(diff);
+  if (i == size)
+    return size;
+  // Bytes of the last word before the tail are already known equal
+  if (size >= 4)
+    return (diff = SSD1680_Word(a + size - 4) ^ SSD1680_Word(b + size - 4)) ? size - 4 + SSD1680_FirstByte(diff) : size;
+  while (i < size && a[i] == b[i])
+    ++i;
+  return i;
+}
+
+/**
+ * @brief Find the last differing byte
+ * @details XORs word at a time from the end and locates the byte within the last nonzero word by counting zero bits.
+ * Head shorter than a word is compared as the first word of the row.
+ * @param[in] a: first row
+ * @param[in] b: second row
+ * @param[in] size: row size
+ * @return Index of the last differing byte. Rows must differ.
+ */
+static uint8_t SSD1680_DiffLast(const uint8_t *a, const uint8_t *b, const uint8_t size) {
+  uint32_t diff;
+  uint8_t i = size;
+  for (; i >= 4; i -= 4)
+    if ((diff = SSD1680_Word(a + i - 4) ^ SSD1680_Word(b + i - 4)))
+      return i - 4 + SSD1680_LastByte(diff);
+  // Bytes of the first word after the head are already known equal
+  if (size >= 4)
+    return SSD1680_LastByte(SSD1680_Word(a) ^ SSD1680_Word(b));
+  while (a[i - 1] == b[i - 1])
+    --i;
+  return i - 1;
+}
+
+/**
+ * @brief Draw whole frame into framebuffer
+ * @details Compares every row with the framebuffer and copies and marks dirty only the span of bytes that changed.
+ * The framebuffer keeps the last frame sent so @ref SSD1680_Flush uploads only the changes.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] image_k: full screen image for primary (black) plane, `Resolution_X / 8` bytes per row. Set to NULL to keep primary plane.
+ * @param[in] image_r: full screen image for secondary (red) plane, `Resolution_X / 8` bytes per row. Set to NULL to keep secondary plane. Ignored for 1 bit color depth.
+ * @param[out] changed: number of bytes in changed spans. Safe to set to NULL.
+ * @return HAL status
+ * @retval HAL_ERROR if there is no framebuffer
+ */
+HAL_StatusTypeDef SSD1680_DrawFrame(SSD1680_HandleTypeDef *hepd, const uint8_t *image_k, const uint8_t *image_r, uint32_t *changed) {
+  SSD1680_FramebufferTypeDef *fb = hepd->Framebuffer;
+  if (!fb)
+    return HAL_ERROR;
+  const uint8_t stride = hepd->Resolution_X / 8;
+  const uint8_t *images[] = { image_k, image_r };
+  uint32_t total = 0;
+  for (uint8_t plane = 0; plane < hepd->Color_Depth; ++plane) {
+    const uint8_t *src = images[plane];
+    if (!src)
+      continue;
+    uint8_t *row = SSD1680_FramebufferPlane(hepd, plane);
+    for (uint16_t y = 0; y < hepd->Resolution_Y; ++y, row += stride, src += stride) {
+      const uint8_t first = SSD1680_DiffFirst(row, src, stride);
+      if (first == stride)
+        continue;
+      const uint8_t last = SSD1680_DiffLast(row, src, stride);
+      memcpy(row + first, src + first, last - first + 1);
+      SSD1680_FramebufferMark(fb, plane, first, last, y, y + 1);
+      total += last - first + 1;
+    }
+  }
+  if (changed)
+    *changed = total;
+  return HAL_OK;
+}
+
+/**
+ * @brief Upload dirty parts of framebuffer into display RAM
+ * @details Dirty rectangles of every plane are merged by @ref SSD1680_PlanRegions and only the result is sent.
+ * The whole framebuffer is sent after reset as RAM content is lost.
+ * Nothing is sent in dry run and the framebuffer stays dirty. @see SSD1680_FrameBegin
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[out] top: topmost uploaded row. Safe to set to NULL.
+ * @param[out] height: number of rows from the topmost to the bottommost uploaded one, 0 if nothing was uploaded. Safe to set to NULL.
+ * @return HAL status
+ * @retval HAL_ERROR if there is no framebuffer
+ * @see SSD1680_RefreshRegion to update the uploaded band of rows
+ */
+HAL_StatusTypeDef SSD1680_Flush(SSD1680_HandleTypeDef *hepd, uint16_t *top, uint16_t *height) {
+  HAL_StatusTypeDef status = HAL_OK;
+  SSD1680_FramebufferTypeDef *fb = hepd->Framebuffer;
+  if (!fb)
+    return HAL_ERROR;
+  // Uploads below are not direct writes, the box stays direct only if it already was and isn't uploaded whole
+  const SSD1680_BoxTypeDef *diff = &hepd->Diff_Box;
+  uint8_t direct = diff->Right > diff->Left && diff->Bottom > diff->Top && hepd->Diff_Direct;
+  if (hepd->Framebuffer_Lost) {
+    for (uint8_t plane = 0; plane < hepd->Color_Depth; ++plane) {
+      fb->Dirty_Count[plane] = 0;
+      SSD1680_FramebufferMark(fb, plane, 0, hepd->Resolution_X / 8 - 1, 0, hepd->Resolution_Y);
+    }
+    hepd->Framebuffer_Lost = hepd->Frame_Dry;
+    direct = 0;
+  }
+  uint16_t bandTop = hepd->Resolution_Y;
+  uint16_t bandBottom = 0;
+  for (uint8_t plane = 0; plane < hepd->Color_Depth && !status; ++plane) {
+    if (!fb->Dirty_Count[plane])
+      continue;
+    if (fb->Dirty_Top[plane] < bandTop)
+      bandTop = fb->Dirty_Top[plane];
+    if (fb->Dirty_Bottom[plane] > bandBottom)
+      bandBottom = fb->Dirty_Bottom[plane];
+    SSD1680_BoxTypeDef boxes[SSD1680_PLAN_BOXES];
+    memcpy(boxes, fb->Dirty[plane], fb->Dirty_Count[plane] * sizeof(boxes[0]));
+    const uint8_t count = SSD1680_PlanRegions(hepd, boxes, fb->Dirty_Count[plane]);
+    for (uint8_t i = 0; i < count && !status; ++i)
+      status = SSD1680_WriteRect(hepd, plane ? RAMRed : RAMBlack, SSD1680_FramebufferPlane(hepd, plane), &boxes[i]);
+    if (!status && !hepd->Frame_Dry) {
+      fb->Dirty_Count[plane] = 0;
+      fb->Dirty_Top[plane] = fb->Dirty_Bottom[plane] = 0;
+    }
+  }
+  hepd->Diff_Direct = direct;
+  if (top)
+    *top = bandBottom ? bandTop : 0;
+  if (height)
+    *height = bandBottom ? bandBottom - bandTop : 0;
+  return status;
+}
+
+/**
+ * @brief Show whole frame
+ * @details Draws the frame into framebuffer, uploads the changes and refreshes the screen picking the mode by the changes:
+ * @li nothing if nothing changed
+ * @li @ref FullRefresh if at least @ref SSD1680_HandleTypeDef::Frame_Full percent of bytes changed or display RAM was lost
+ * @li region limited @ref PartialRefresh if changed rows fit @ref SSD1680_HandleTypeDef::Frame_Band
+ * @li @ref FastPartialRefresh otherwise
+ *
+ * Doesn't refresh in dry run. @see SSD1680_FrameBegin
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] image_k: full screen image for primary (black) plane, `Resolution_X / 8` bytes per row. Set to NULL to keep primary plane.
+ * @param[in] image_r: full screen image for secondary (red) plane, `Resolution_X / 8` bytes per row. Set to NULL to keep secondary plane.
+ * @return HAL status
+ * @note Slow. Waits for display to complete operation unless @ref SSD1680_HandleTypeDef::Lazy_Wait is set.
+ * @see SSD1680_DrawFrame
+ */
+HAL_StatusTypeDef SSD1680_ShowFrame(SSD1680_HandleTypeDef *hepd, const uint8_t *image_k, const uint8_t *image_r) {
+  HAL_StatusTypeDef status = HAL_OK;
+  const uint8_t lost = hepd->Framebuffer_Lost;
+  uint32_t changed;
+  if ((status = SSD1680_DrawFrame(hepd, image_k, image_r, &changed)))
+    return status;
+  uint16_t top;
+  uint16_t height;
+  if ((status = SSD1680_Flush(hepd, &top, &height)))
+    return status;
+  if (!height || hepd->Frame_Dry)
+    return status;
+  const uint32_t total = (uint32_t)(hepd->Resolution_X / 8) * hepd->Resolution_Y * hepd->Color_Depth;
+  const uint8_t full = hepd->Frame_Full ? hepd->Frame_Full : SSD1680_FRAME_FULL;
+  const uint16_t band = hepd->Frame_Band ? hepd->Frame_Band : SSD1680_FRAME_BAND;
+  if (lost || changed * 100 >= total * full)
+    return SSD1680_Refresh(hepd, FullRefresh);
+  if (height <= band)
+    return SSD1680_RefreshRegion(hepd, top, height, PartialRefresh);
+  return SSD1680_Refresh(hepd, FastPartialRefresh);
+}
+
+/**
+ * @brief Forget recorded drawing operations
+ * @param[in] list: display list pointer
+ */
+void SSD1680_ListClear(SSD1680_DisplayListTypeDef *list) {
+  list->Count = 0;
+}
+
+/**
+ * @brief Record drawing operation
+ * @param[in] list: display list pointer
+ * @param[in] item: drawing operation
+ * @return HAL status
+ * @retval HAL_ERROR if the list is full
+ */
+static HAL_StatusTypeDef SSD1680_ListAdd(SSD1680_DisplayListTypeDef *list, const SSD1680_DrawItemTypeDef *item) {
+  if (list->Count >= list->Capacity)
+    return HAL_ERROR;
+  list->Items[list->Count++] = *item;
+  return HAL_OK;
+}
+
+/**
+ * @brief Record filled rectangle
+ * @param[in] list: display list pointer
+ * @param[in] left: leftmost column
+ * @param[in] top: topmost row
+ * @param[in] width: rectangle width
+ * @param[in] height: rectangle height
+ * @param[in] color: fill color
+ * @return HAL status
+ * @retval HAL_ERROR if the list is full
+ */
+HAL_StatusTypeDef SSD1680_ListFill(SSD1680_DisplayListTypeDef *list, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const enum SSD1680_Color color) {
+  const SSD1680_DrawItemTypeDef item = { DrawFill, color, left, left + width, top, top + height, NULL, NULL };
+  return SSD1680_ListAdd(list, &item);
+}
+
+/**
+ * @brief Record line
+ * @details Both ends are drawn.
+ * @param[in] list: display list pointer
+ * @param[in] x0: start column
+ * @param[in] y0: start row
+ * @param[in] x1: end column
+ * @param[in] y1: end row
+ * @param[in] color: line color
+ * @return HAL status
+ * @retval HAL_ERROR if the list is full
+ */
+HAL_StatusTypeDef SSD1680_ListLine(SSD1680_DisplayListTypeDef *list, const uint8_t x0, const uint16_t y0, const uint8_t x1, const uint16_t y1, const enum SSD1680_Color color) {
+  const SSD1680_DrawItemTypeDef item = { DrawLine, color, x0, x1, y0, y1, NULL, NULL };
+  return SSD1680_ListAdd(list, &item);
+}
+
+/**
+ * @brief Record image
+ * @details Takes the same data as @ref SSD1680_SetRegion.
+ * @param[in] list: display list pointer
+ * @param[in] left: leftmost column. Must be multiple of 8.
+ * @param[in] top: topmost row
+ * @param[in] width: image width. Must be multiple of 8.
+ * @param[in] height: image height
+ * @param[in] data_k: pointer to `width / 8 * height` bytes of primary (black) plane or NULL to keep it
+ * @param[in] data_r: pointer to `width / 8 * height` bytes of secondary (red) plane or NULL to keep it
+ * @return HAL status
+ * @retval HAL_ERROR if the list is full
+ */
+HAL_StatusTypeDef SSD1680_ListBitmap(SSD1680_DisplayListTypeDef *list, const uint8_t left, const uint16_t top, const uint8_t width, const uint16_t height, const uint8_t *data_k, const uint8_t *data_r) {
+  const SSD1680_DrawItemTypeDef item = { DrawBitmap, 0, left, left + width, top, top + height, data_k, data_r };
+  return SSD1680_ListAdd(list, &item);
+}
+
+/**
+ * @brief Record text
+ * @details Only glyph pixels are drawn, background is kept.
+ * Supports the same control characters as @ref SSD1680_Text.
+ * @param[in] list: display list pointer
+ * @param[in] left: horizontal position of a string
+ * @param[in] top: vertical position of a string
+ * @param[in] string: zero-terminated string to print
+ * @param[in] font: pointer to font
+ * @param[in] color: text color
+ * @return HAL status
+ * @retval HAL_ERROR if the list is full
+ */
+HAL_StatusTypeDef SSD1680_ListText(SSD1680_DisplayListTypeDef *list, const uint8_t left, const uint16_t top, const char *string, const SSD1680_FontTypeDef *font, const enum SSD1680_Color color) {
+  const SSD1680_DrawItemTypeDef item = { DrawText, color, left, 0, top, 0, string, font };
+  return SSD1680_ListAdd(list, &item);
+}
+
+/**
+ * @brief Set pixel of a band
+ * @param[in] band: band buffer
+ * @param[in] planeSize: size of a plane of the band in bytes
+ * @param[in] stride: row size in bytes
+ * @param[in] depth: color depth
+ * @param[in] x: column
+ * @param[in] y: row within the band
+ * @param[in] color: pixel color
+ */
+static inline void SSD1680_BandPlot(uint8_t *band, const uint16_t planeSize, const uint8_t stride, const uint8_t depth, const uint8_t x, const uint16_t y, const uint8_t color) {
+  const uint8_t mask = 0x80 >> (x & 7);
+  uint8_t *byte = band + y * stride + x / 8;
+  for (uint8_t plane = 0; plane < depth; ++plane, byte += planeSize) {
+    if ((color >> plane) & 1)
+      *byte |= mask;
+    else
+      *byte &= ~mask;
+  }
+}
+
+/**
+ * @brief Rasterize display list item into a band
+ * @details Draws only the part of the item falling into the band.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] item: display list item
+ * @param[out] band: band buffer
+ * @param[in] planeSize: size of a plane of the band in bytes
+ * @param[in] top: topmost row of the band
+ * @param[in] rows: number of rows in the band
+ */
+static void SSD1680_RenderItem(SSD1680_HandleTypeDef *hepd, const SSD1680_DrawItemTypeDef *item, uint8_t *band, const uint16_t planeSize, const uint16_t top, const uint16_t rows) {
+  const uint8_t stride = hepd->Resolution_X / 8;
+  const uint8_t depth = hepd->Color_Depth;
+  const uint16_t bottom = top + rows;
+  switch (item->Op) {
+  case DrawFill:
+  case DrawBitmap:
+    {
+      const uint16_t y0 = item->Y0 > top ? item->Y0 : top;
+      const uint16_t y1 = item->Y1 < bottom ? item->Y1 : bottom;
+      const uint8_t x1 = item->X1 < hepd->Resolution_X ? item->X1 : hepd->Resolution_X;
+      if (y0 >= y1 || item->X0 >= x1)
+        return;
+      if (item->Op == DrawFill) {
+        for (uint8_t plane = 0; plane < depth; ++plane)
+          SSD1680_FillRows(band + plane * planeSize + (y0 - top) * stride, stride, y1 - y0, item->X0, x1 - item->X0, (item->Color >> plane) & 1);
+        return;
+      }
+      const uint8_t *data[] = { item->Data, item->Aux };
+      const uint8_t width = (item->X1 - item->X0) / 8;
+      for (uint8_t plane = 0; plane < depth; ++plane) {
+        if (!data[plane])
+          continue;
+        for (uint16_t y = y0; y < y1; ++y)
+          memcpy(band + plane * planeSize + (y - top) * stride + item->X0 / 8, data[plane] + (y - item->Y0) * width, (x1 - item->X0) / 8);
+      }
+    }
+    return;
+  case DrawLine:
+    {
+      if ((item->Y0 < top && item->Y1 < top) || (item->Y0 >= bottom && item->Y1 >= bottom))
+        return;
+      const int16_t dx = abs(item->X1 - item->X0);
+      const int16_t dy = -abs(item->Y1 - item->Y0);
+      const int8_t sx = item->X0 < item->X1 ? 1 : -1;
+      const int8_t sy = item->Y0 < item->Y1 ? 1 : -1;
+      int16_t x = item->X0;
+      int16_t y = item->Y0;
+      int16_t error = dx + dy;
+      for (;;) {
+        if (y >= top && y < bottom && x < hepd->Resolution_X)
+          SSD1680_BandPlot(band, planeSize, stride, depth, x, y - top, item->Color);
+        if (x == item->X1 && y == item->Y1)
+          break;
+        const int16_t e2 = 2 * error;
+        if (e2 >= dy) {
+          error += dy;
+          x += sx;
+        }
+        if (e2 <= dx) {
+          error += dx;
+          y += sy;
+        }
+      }
+    }
+    return;
+  case DrawText:
+    {
+      const char *string = item->Data;
+      const SSD1680_FontTypeDef *font = item->Aux;
+      const uint8_t tab_width = 4;
+      const uint8_t glyphStride = font->width / 8;
+      uint8_t pos_x = 0;
+      uint8_t pos_y = 0;
+      for (; *string; ++string) {
+        switch (*string) {
+        case 0x08:    // backspace
+          if (pos_x)
+            --pos_x;
+          break;
+        case 0x09:    // tab
+          pos_x = (pos_x / tab_width + 1) * tab_width;
+          break;
+        case 0x0A:    // line feed
+          ++pos_y;
+          pos_x = 0;
+          break;
+        case 0x0D:    // carriage return
+          pos_x = 0;
+          break;
+        default:
+          {
+            const uint16_t left = item->X0 + font->width * pos_x++;
+            const uint16_t glyphTop = item->Y0 + font->height * pos_y;
+            const uint16_t y0 = glyphTop > top ? glyphTop : top;
+            const uint16_t y1 = glyphTop + font->height < bottom ? glyphTop + font->height : bottom;
+            const uint8_t *glyph = font->data + (unsigned char)*string * glyphStride * font->height;
+            for (uint16_t y = y0; y < y1; ++y) {
+              const uint8_t *bits = glyph + (y - glyphTop) * glyphStride;
+              for (uint8_t x = 0; x < font->width && left + x < hepd->Resolution_X; ++x)
+                if (bits[x / 8] & (0x80 >> (x & 7)))
+                  SSD1680_BandPlot(band, planeSize, stride, depth, left + x, y - top, item->Color);
+            }
+          }
+        }
+      }
+    }
+    return;
+  }
+}
+
+/**
+ * @brief Rasterize display list into a band
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] list: display list pointer
+ * @param[out] band: band buffer
+ * @param[in] planeSize: size of a plane of the band in bytes
+ * @param[in] top: topmost row of the band
+ * @param[in] rows: number of rows in the band
+ * @param[in] background: color of pixels not covered by any item
+ */
+static void SSD1680_RenderBand(SSD1680_HandleTypeDef *hepd, const SSD1680_DisplayListTypeDef *list, uint8_t *band, const uint16_t planeSize, const uint16_t top, const uint16_t rows, const enum SSD1680_Color background) {
+  const uint8_t stride = hepd->Resolution_X / 8;
+  for (uint8_t plane = 0; plane < hepd->Color_Depth; ++plane)
+    memset(band + plane * planeSize, (background >> plane) & 1 ? 0xFF : 0x00, stride * rows);
+  for (uint8_t i = 0; i < list->Count; ++i)
+    SSD1680_RenderItem(hepd, &list->Items[i], band, planeSize, top, rows);
+}
+
+/**
+ * @brief Render display list to the screen
+ * @details Rasterizes the list into band buffer a few rows at a time and sends every band with @ref SSD1680_SetRegion
+ * before the next one is rasterized. Peak memory depends on band height rather than the screen size.
+ * Every band costs one more upload and one more pass over the list, so taller bands are faster.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] list: display list pointer
+ * @param[out] band: band buffer of @ref SSD1680_FB_SIZE(Resolution_X, rows, Color_Depth) bytes
+ * @param[in] rows: band height
+ * @param[in] background: color of pixels not covered by any item
+ * @return HAL status
+ * @retval HAL_ERROR if band is empty
+ * @note Secondary (red) RAM bank is not written for 1 bit color depth.
+ * @see SSD1680_RenderList_DMA for pipelined version
+ */
+HAL_StatusTypeDef SSD1680_RenderList(SSD1680_HandleTypeDef *hepd, const SSD1680_DisplayListTypeDef *list, uint8_t *band, const uint16_t rows, const enum SSD1680_Color background) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (!rows)
+    return HAL_ERROR;
+  const uint16_t planeSize = hepd->Resolution_X / 8 * rows;
+  for (uint16_t top = 0; top < hepd->Resolution_Y && !status; top += rows) {
+    const uint16_t height = hepd->Resolution_Y - top < rows ? hepd->Resolution_Y - top : rows;
+    SSD1680_RenderBand(hepd, list, band, planeSize, top, height, background);
+    status = SSD1680_SetRegion(hepd, 0, top, hepd->Resolution_X, height, band, hepd->Color_Depth > 1 ? band + planeSize : NULL);
+  }
+  return status;
+}
+
+/**
+ * @brief Abort DMA transfer
+ * @details Stops SPI DMA, releases CS line and returns driver into ready state, so that the buffer is no longer in use.
+ * Shadow copy is forgotten as commands may have been cut off.
+ * @param[in] hepd: SSD1680 handle pointer
+ */
+static void SSD1680_TransferAbort(SSD1680_HandleTypeDef *hepd) {
+  // Late completion callback must find nothing to chain
+  if (hepd->State == StateTransmit || hepd->State == StateReceive)
+    hepd->State = StateReady;
+  hepd->DMA_Data = NULL;
+  hepd->DMA_Chain_Size = 0;
+  HAL_SPI_Abort(hepd->SPI_Handle);
+  SSD1680_EndTransfer(hepd);
+  SSD1680_InvalidateShadow(hepd);
+}
+
+/**
+ * @brief Wait for DMA transfer completion
+ * @details Sleeps with `__WFI` until SSD1680_SPI_CpltCallback or SSD1680_SPI_ErrorCallback finishes the transfer.
+ * Failed or timed out transfer is aborted with SSD1680_TransferAbort.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @return HAL status of the transfer
+ * @retval HAL_TIMEOUT if the transfer didn't complete in @ref SSD1680_HandleTypeDef::SPI_Timeout ms
+ */
+static HAL_StatusTypeDef SSD1680_TransferWait(SSD1680_HandleTypeDef *hepd) {
+  HAL_StatusTypeDef status = HAL_OK;
+  const uint32_t start = HAL_GetTick();
+  while (!status && (hepd->State == StateTransmit || hepd->State == StateReceive)) {
+    if (HAL_GetTick() - start > hepd->SPI_Timeout)
+      status = HAL_TIMEOUT;
+    else
+      __WFI();
+  }
+  if (!status) {
+    status = hepd->DMA_Status;
+    hepd->DMA_Status = HAL_OK;
+  }
+  if (status)
+    SSD1680_TransferAbort(hepd);
+  return status;
+}
+
+/**
+ * @brief Render display list to the screen overlapping rasterization with DMA
+ * @details Rasterizes the next band into one buffer while the previous band is sent from the other one by @ref SSD1680_SetRegion_DMA.
+ * Buffers are swapped when DMA transfer completes, so frame takes about the longest of rasterization and transfer rather than their sum.
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] list: display list pointer
+ * @param[out] band0: band buffer of @ref SSD1680_FB_SIZE(Resolution_X, rows, Color_Depth) bytes
+ * @param[out] band1: another band buffer of the same size. Set to NULL to render and transfer one after another in a single buffer.
+ * @param[in] rows: band height
+ * @param[in] background: color of pixels not covered by any item
+ * @return HAL status
+ * @retval HAL_ERROR if band is empty
+ * @retval HAL_TIMEOUT if band transfer didn't complete in @ref SSD1680_HandleTypeDef::SPI_Timeout ms
+ * @note Band buffers are in use by DMA until the call returns and must not be reused before.
+ * On timeout or SPI error the transfer is aborted and CS line released before returning.
+ * @note SSD1680_SPI_CpltCallback must be called from `HAL_SPI_TxCpltCallback`.
+ * @see SSD1680_RenderList for blocking version
+ */
+HAL_StatusTypeDef SSD1680_RenderList_DMA(SSD1680_HandleTypeDef *hepd, const SSD1680_DisplayListTypeDef *list, uint8_t *band0, uint8_t *band1, const uint16_t rows, const enum SSD1680_Color background) {
+  HAL_StatusTypeDef status = HAL_OK;
+  if (!rows)
+    return HAL_ERROR;
+  // Failure of an earlier transfer already over is not this list's
+  if (hepd->State != StateTransmit && hepd->State != StateReceive)
+    hepd->DMA_Status = HAL_OK;
+  uint8_t *bands[] = { band0, band1 ? band1 : band0 };
+  const uint16_t planeSize = hepd->Resolution_X / 8 * rows;
+  uint8_t current = 0;
+  for (uint16_t top = 0; top < hepd->Resolution_Y && !status; top += rows, current ^= 1) {
+    const uint16_t height = hepd->Resolution_Y - top < rows ? hepd->Resolution_Y - top : rows;
+    uint8_t *band = bands[current];
+    // The only buffer is still being sent
+    if (!band1 && (status = SSD1680_TransferWait(hepd)))
+      break;
+    SSD1680_RenderBand(hepd, list, band, planeSize, top, height, background);
+    if ((status = SSD1680_TransferWait(hepd)))
+      break;
+    status = SSD1680_SetRegion_DMA(hepd, 0, top, hepd->Resolution_X, height, band, hepd->Color_Depth > 1 ? band + planeSize : NULL);
+  }
+  // Buffers must not be released while in use
+  const HAL_StatusTypeDef transfer = SSD1680_TransferWait(hepd);
+  return status ? status : transfer;
+}
+
 /*
 void ByteGridTranspose(uint8_t *out, const uint16_t width, const uint16_t height, const uint8_t *in) {
   for (uint16_t y = 0; y < height; ++y)
@@ -0,0 +1,45 @@
+/*
+ * stm32f1xx_hal.h
+ *
+ * Host stand-in for the part of STM32 HAL the driver uses.
+ * Implemented by stub_hal.c.
+ */
+
+#ifndef __STM32F1XX_HAL_H__
+#define __STM32F1XX_HAL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+  HAL_OK = 0,
+  HAL_ERROR,
+  HAL_BUSY,
+  HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef enum {
+  GPIO_PIN_RESET = 0,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct {
+  volatile uint32_t CRL, CRH, IDR, ODR, BSRR, BRR, LCKR;
+} GPIO_TypeDef;
+
+typedef struct {
+  uint32_t Instance;
+} SPI_HandleTypeDef;
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef *hspi);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+void __WFI(void);
+
+#endif // __STM32F1XX_HAL_H__
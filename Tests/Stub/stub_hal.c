@@ -0,0 +1,272 @@
+/*
+ * stub_hal.c
+ *
+ * Host stand-in for STM32 HAL with a simulated display controller:
+ * BUSY line raised by master activation for as long as its stages take and by both hardware and software reset,
+ * RAM banks written through address counters and SPI DMA completing either on demand or after simulated transfer time.
+ */
+
+#include "stub_hal.h"
+#include <string.h>
+#include <time.h>
+
+Stub_TypeDef Stub;
+GPIO_TypeDef Stub_CS, Stub_DC, Stub_RESET, Stub_BUSY;
+SPI_HandleTypeDef Stub_SPI;
+
+/**
+ * @brief Reset simulator
+ * @details Clears counters, log and RAM banks. Time keeps running.
+ */
+void Stub_Reset(void) {
+  const uint32_t tick = Stub.Tick;
+  memset(&Stub, 0, sizeof(Stub));
+  Stub.Tick = tick;
+  Stub.RX_Fill = 0xA5;
+  Stub.Temp = STUB_TEMP;
+  Stub.X_End = STUB_RAM_WIDTH - 1;
+  Stub.Y_End = STUB_RAM_HEIGHT - 1;
+  Stub.Sequence = 0xFF;
+  Stub.Gate_Lines = STUB_RAM_HEIGHT;
+}
+
+/**
+ * @brief Clear SPI transmit log and counters
+ */
+void Stub_ClearLog(void) {
+  Stub.Log_Size = 0;
+  Stub.SPI_Calls = 0;
+  Stub.SPI_Bytes = 0;
+  Stub.Delays = 0;
+  Stub.Pin_Reads = 0;
+  Stub.WFI_Count = 0;
+}
+
+/**
+ * @brief Get real time
+ * @return Monotonic time in ns
+ */
+int64_t Stub_Now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Raise BUSY line
+ * @param[in] time: BUSY period in ms
+ */
+static void Stub_Busy(const uint32_t time) {
+  Stub.Busy_Until = Stub.Tick + time;
+  Stub.Busy_Time = time;
+  Stub.Busy_Prev = 1;
+}
+
+/**
+ * @brief Reset controller registers
+ * @details Update control 2 and gate lines return to power on values and BUSY is held while the controller boots.
+ */
+static void Stub_Boot(void) {
+  Stub.Sequence = 0xFF;
+  Stub.Gate_Lines = STUB_RAM_HEIGHT;
+  Stub_Busy(STUB_RESET_TIME);
+}
+
+/**
+ * @brief Get BUSY period of master activation
+ * @details Sum of temperature load, LUT load and display stages of update control 2 in effect.
+ * Display stage takes time proportional to the number of gate lines. Any sequence takes at least 1 ms.
+ * @return Time in ms
+ */
+static uint32_t Stub_ActivationTime(void) {
+  uint32_t time = 0;
+  if (Stub.Sequence & 0x20)
+    time += STUB_TEMP_TIME;
+  if (Stub.Sequence & 0x10)
+    time += STUB_LUT_TIME;
+  if (Stub.Sequence & 0x04)
+    time += (uint32_t)STUB_REFRESH_TIME * Stub.Gate_Lines / STUB_RAM_HEIGHT;
+  return time ? time : 1;
+}
+
+/**
+ * @brief Interpret bytes sent to the controller
+ * @details !DC line low marks command byte, high marks arguments or RAM data.
+ * @param[in] pData: pointer to data
+ * @param[in] size: size of data
+ */
+static void Stub_Feed(const uint8_t *pData, const uint16_t size) {
+  const uint8_t command = !(Stub_DC.BSRR & STUB_DC_PIN);
+  for (uint16_t i = 0; i < size; ++i) {
+    if (command) {
+      Stub.Command = pData[i];
+      Stub.Arg_Count = 0;
+      if (Stub.Command == 0x20)
+        Stub_Busy(Stub_ActivationTime());
+      else if (Stub.Command == 0x12)
+        Stub_Boot();
+      continue;
+    }
+    if (Stub.Command == 0x24 || Stub.Command == 0x26) {
+      if (Stub.X < STUB_RAM_WIDTH && Stub.Y < STUB_RAM_HEIGHT)
+        Stub.RAM[Stub.Command == 0x26][Stub.Y][Stub.X] = pData[i];
+      if (++Stub.X > Stub.X_End) {
+        Stub.X = Stub.X_Start;
+        if (++Stub.Y > Stub.Y_End)
+          Stub.Y = Stub.Y_Start;
+      }
+      continue;
+    }
+    if (Stub.Arg_Count < sizeof(Stub.Args))
+      Stub.Args[Stub.Arg_Count++] = pData[i];
+    if (Stub.Command == 0x01 && Stub.Arg_Count == 3) {
+      Stub.Gate_Lines = (Stub.Args[0] | Stub.Args[1] << 8) + 1;
+    } else if (Stub.Command == 0x22 && Stub.Arg_Count == 1) {
+      Stub.Sequence = Stub.Args[0];
+    } else if (Stub.Command == 0x44 && Stub.Arg_Count == 2) {
+      Stub.X_Start = Stub.Args[0];
+      Stub.X_End = Stub.Args[1];
+    } else if (Stub.Command == 0x45 && Stub.Arg_Count == 4) {
+      Stub.Y_Start = Stub.Args[0] | Stub.Args[1] << 8;
+      Stub.Y_End = Stub.Args[2] | Stub.Args[3] << 8;
+    } else if (Stub.Command == 0x4E && Stub.Arg_Count == 1) {
+      Stub.X = Stub.Args[0];
+    } else if (Stub.Command == 0x4F && Stub.Arg_Count == 2) {
+      Stub.Y = Stub.Args[0] | Stub.Args[1] << 8;
+    }
+  }
+}
+
+/**
+ * @brief Start simulated DMA transfer
+ * @param[in] pData: pointer to buffer
+ * @param[in] size: size of buffer
+ * @param[in] receive: non-zero for reception
+ * @return HAL status
+ */
+static HAL_StatusTypeDef Stub_DMAStart(uint8_t *pData, const uint16_t size, const uint8_t receive) {
+  if (Stub.DMA_Pending)
+    return HAL_BUSY;
+  if (Stub.DMA_NS_Per_Byte)
+    Stub.DMA_End = (Stub.DMA_In_Callback ? Stub.DMA_End : Stub_Now()) + (int64_t)size * Stub.DMA_NS_Per_Byte;
+  Stub.DMA_Pending = 1;
+  Stub.DMA_Receive = receive;
+  Stub.DMA_Data = pData;
+  Stub.DMA_Size = size;
+  ++Stub.SPI_Calls;
+  Stub.SPI_Bytes += size;
+  if (receive)
+    memset(pData, Stub.RX_Fill, size);
+  else
+    Stub_Feed(pData, size);
+  return HAL_OK;
+}
+
+/**
+ * @brief Complete DMA transfer in flight
+ * @details Calls @ref Stub_TypeDef::DMA_Callback that may start the next transfer.
+ */
+void Stub_DMAComplete(void) {
+  if (!Stub.DMA_Pending)
+    return;
+  Stub.DMA_Pending = 0;
+  if (Stub.DMA_Callback) {
+    Stub.DMA_In_Callback = 1;
+    Stub.DMA_Callback();
+    Stub.DMA_In_Callback = 0;
+  }
+}
+
+/**
+ * @details Writes BSRR the way HAL does, so line state is the last BSRR write whether the driver calls it or writes BSRR directly.
+ */
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+  // Controller boots after hardware reset is released
+  if (GPIOx == &Stub_RESET && PinState == GPIO_PIN_SET && !(GPIOx->ODR & GPIO_Pin)) {
+    if (Stub.Busy_Stuck == 1)
+      Stub.Busy_Stuck = 0;
+    Stub_Boot();
+  }
+  GPIOx->BSRR = PinState == GPIO_PIN_SET ? GPIO_Pin : (uint32_t)GPIO_Pin << 16;
+  if (PinState == GPIO_PIN_SET)
+    GPIOx->ODR |= GPIO_Pin;
+  else
+    GPIOx->ODR &= ~GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  ++Stub.Pin_Reads;
+  if (GPIOx == &Stub_BUSY)
+    return Stub.Busy_Stuck || (int32_t)(Stub.Tick - Stub.Busy_Until) < 0 ? GPIO_PIN_SET : GPIO_PIN_RESET;
+  return GPIOx->ODR & GPIO_Pin ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+  (void)hspi;
+  (void)Timeout;
+  if (Stub.DMA_Pending)
+    return HAL_BUSY;
+  ++Stub.SPI_Calls;
+  Stub.SPI_Bytes += Size;
+  for (uint16_t i = 0; i < Size && Stub.Log_Size < sizeof(Stub.Log); ++i)
+    Stub.Log[Stub.Log_Size++] = pData[i];
+  Stub_Feed(pData, Size);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+  (void)hspi;
+  (void)Timeout;
+  if (Stub.DMA_Pending)
+    return HAL_BUSY;
+  ++Stub.SPI_Calls;
+  Stub.SPI_Bytes += Size;
+  memset(pData, Stub.RX_Fill, Size);
+  // Temperature register holds 12 bit value in 1/16 °C, MSB first
+  if (Stub.Command == 0x1B && Size >= 2) {
+    pData[0] = Stub.Temp;
+    pData[1] = 0x00;
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size) {
+  (void)hspi;
+  return Stub_DMAStart(pData, Size, 0);
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size) {
+  (void)hspi;
+  return Stub_DMAStart(pData, Size, 1);
+}
+
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef *hspi) {
+  (void)hspi;
+  ++Stub.Aborts;
+  Stub.DMA_Pending = 0;
+  return HAL_OK;
+}
+
+uint32_t HAL_GetTick(void) {
+  return Stub.Tick;
+}
+
+void HAL_Delay(uint32_t Delay) {
+  ++Stub.Delays;
+  Stub.Tick += Delay + 1;
+}
+
+/**
+ * @brief Sleep until the next interrupt
+ * @details Every wakeup is one SysTick. Completes timed DMA transfer and reports BUSY falling edge.
+ */
+void __WFI(void) {
+  ++Stub.WFI_Count;
+  if (Stub.DMA_NS_Per_Byte && Stub.DMA_Pending && Stub_Now() >= Stub.DMA_End)
+    Stub_DMAComplete();
+  ++Stub.Tick;
+  const uint8_t busy = Stub.Busy_Stuck || (int32_t)(Stub.Tick - Stub.Busy_Until) < 0;
+  if (Stub.Busy_Prev && !busy && Stub.BUSY_Callback)
+    Stub.BUSY_Callback();
+  Stub.Busy_Prev = busy;
+}
@@ -0,0 +1,76 @@
+/*
+ * stub_hal.h
+ *
+ * Controls of the simulated HAL and display controller used by host tests.
+ */
+
+#ifndef __STUB_HAL_H__
+#define __STUB_HAL_H__
+
+#include "stm32f1xx_hal.h"
+
+#define STUB_CS_PIN 0x01		/**< CS pin on @ref Stub_CS port */
+#define STUB_DC_PIN 0x02		/**< !DC pin on @ref Stub_DC port */
+#define STUB_RESET_PIN 0x04		/**< !RESET pin on @ref Stub_RESET port */
+#define STUB_BUSY_PIN 0x08		/**< BUSY pin on @ref Stub_BUSY port */
+
+#define STUB_RAM_WIDTH 22		/**< Bytes per row of simulated RAM bank */
+#define STUB_RAM_HEIGHT 296		/**< Rows of simulated RAM bank */
+
+#define STUB_REFRESH_TIME 100	/**< BUSY period of display stage of master activation over all gate lines in ms */
+#define STUB_TEMP_TIME 5		/**< BUSY period of temperature load stage of master activation in ms */
+#define STUB_LUT_TIME 10		/**< BUSY period of LUT load stage of master activation in ms */
+#define STUB_RESET_TIME 5		/**< BUSY period of hardware and software reset in ms */
+#define STUB_TEMP 25			/**< Temperature read from the sensor after reset in °C */
+
+#define STUB_LOG_SIZE 65536		/**< Size of SPI transmit log */
+
+/**
+ * @struct Stub_TypeDef
+ * Simulator state
+ */
+typedef struct {
+  uint32_t Tick;				/**< Simulated time in ms. Advanced by HAL_Delay and by every `__WFI` */
+  uint32_t Busy_Until;			/**< Time BUSY line goes low */
+  uint32_t Busy_Time;			/**< Length of the last BUSY period in ms */
+  uint8_t Busy_Stuck;			/**< Non-zero to keep BUSY line high. 1 is released by hardware reset, other values hold through it. */
+  uint8_t Busy_Prev;			/**< BUSY line state seen by the last `__WFI` */
+  uint8_t RX_Fill;				/**< Value of every received byte but temperature */
+  int8_t Temp;					/**< Temperature read from the sensor in °C */
+  uint32_t Delays;				/**< Number of HAL_Delay calls */
+  uint32_t Pin_Reads;			/**< Number of HAL_GPIO_ReadPin calls */
+  uint32_t WFI_Count;			/**< Number of `__WFI` calls */
+  uint32_t SPI_Calls;			/**< Number of SPI transfers, polled and DMA */
+  uint32_t SPI_Bytes;			/**< Number of bytes transferred over SPI */
+  uint32_t Aborts;				/**< Number of HAL_SPI_Abort calls */
+  uint8_t Log[STUB_LOG_SIZE];	/**< Bytes transmitted by polling, commands and arguments alike */
+  uint32_t Log_Size;			/**< Used size of Log */
+  uint8_t DMA_Pending;			/**< Non-zero while DMA transfer is in flight */
+  uint8_t DMA_Receive;			/**< Non-zero if DMA transfer in flight is reception */
+  uint8_t *DMA_Data;			/**< Buffer of DMA transfer in flight */
+  uint16_t DMA_Size;			/**< Size of DMA transfer in flight */
+  uint32_t DMA_NS_Per_Byte;		/**< Real time DMA transfer takes per byte. Set to 0 to complete it only with Stub_DMAComplete. */
+  int64_t DMA_End;				/**< Real time in ns DMA transfer in flight completes at */
+  uint8_t DMA_In_Callback;		/**< Non-zero while DMA_Callback runs */
+  void (*DMA_Callback)(void);	/**< Called on DMA completion, stand-in for `HAL_SPI_TxCpltCallback` */
+  void (*BUSY_Callback)(void);	/**< Called from `__WFI` on BUSY falling edge, stand-in for EXTI handler */
+  uint8_t RAM[2][STUB_RAM_HEIGHT][STUB_RAM_WIDTH];	/**< Controller RAM banks, black and red */
+  uint8_t Command;				/**< Last command byte */
+  uint8_t Args[8];				/**< Arguments of the last command */
+  uint8_t Arg_Count;			/**< Number of arguments of the last command received */
+  uint8_t X_Start, X_End, X;	/**< RAM X range and address counter in bytes */
+  uint16_t Y_Start, Y_End, Y;	/**< RAM Y range and address counter in rows */
+  uint8_t Sequence;				/**< Update control 2 in effect */
+  uint16_t Gate_Lines;			/**< Number of gate lines driven by display stage */
+} Stub_TypeDef;
+
+extern Stub_TypeDef Stub;
+extern GPIO_TypeDef Stub_CS, Stub_DC, Stub_RESET, Stub_BUSY;
+extern SPI_HandleTypeDef Stub_SPI;
+
+void Stub_Reset(void);
+void Stub_ClearLog(void);
+void Stub_DMAComplete(void);
+int64_t Stub_Now(void);
+
+#endif // __STUB_HAL_H__
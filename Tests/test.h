@@ -0,0 +1,67 @@
+/*
+ * test.h
+ *
+ * Helpers shared by host tests. Every test is a program exiting with non-zero status on the first failed check.
+ */
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include "SSD1680.h"
+#include "stub_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Fail the test unless condition holds
+ */
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      exit(1); \
+    } \
+  } while (0)
+
+/**
+ * @brief Set up 2.7" 176x296 panel on simulated pins
+ * @param[out] hepd: SSD1680 handle pointer
+ * @param[in] depth: color depth, 1 or 2
+ */
+static inline void Test_Handle(SSD1680_HandleTypeDef *hepd, const uint8_t depth) {
+  memset(hepd, 0, sizeof(*hepd));
+  hepd->SPI_Handle = &Stub_SPI;
+  hepd->SPI_Timeout = 100;
+  hepd->CS_Port = &Stub_CS;
+  hepd->CS_Pin = STUB_CS_PIN;
+  hepd->DC_Port = &Stub_DC;
+  hepd->DC_Pin = STUB_DC_PIN;
+  hepd->RESET_Port = &Stub_RESET;
+  hepd->RESET_Pin = STUB_RESET_PIN;
+  hepd->BUSY_Port = &Stub_BUSY;
+  hepd->BUSY_Pin = STUB_BUSY_PIN;
+  hepd->Color_Depth = depth;
+  hepd->Resolution_X = 176;
+  hepd->Resolution_Y = 296;
+  Stub_Reset();
+}
+
+/**
+ * @brief Check that CS line is released
+ */
+static inline uint8_t Test_Released(void) {
+  return (Stub_CS.BSRR & STUB_CS_PIN) != 0;
+}
+
+/**
+ * @brief Print bytes transmitted by polling since the log was cleared
+ * @param[in] name: label
+ */
+static inline void Test_Dump(const char *name) {
+  printf("%s:", name);
+  for (uint32_t i = 0; i < Stub.Log_Size; ++i)
+    printf(" %02x", Stub.Log[i]);
+  printf("\n");
+}
+
+#endif // __TEST_H__
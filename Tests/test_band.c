@@ -0,0 +1,54 @@
+/*
+ * test_band.c
+ *
+ * Band rendering of display lists: every band height leaves the same image in controller RAM.
+ */
+
+#include "test.h"
+#include "fonts.h"
+#include <time.h>
+
+#define REPEATS 20		/**< Renders per band height for timing */
+
+extern const unsigned char girl15_k[], girl15_r[];
+
+int main(void) {
+  static const uint16_t heights[] = { 296, 148, 64, 32, 16, 8, 4, 1 };
+  static uint8_t band[SSD1680_FB_SIZE(176, 296, 2)];
+  static uint8_t image[2][STUB_RAM_HEIGHT][STUB_RAM_WIDTH];
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  CHECK(!SSD1680_Init(&hepd));
+
+  SSD1680_DrawItemTypeDef items[16];
+  SSD1680_DisplayListTypeDef list = { items, sizeof(items) / sizeof(items[0]), 0 };
+  CHECK(!SSD1680_ListFill(&list, 0, 0, 176, 20, ColorBlack));
+  CHECK(!SSD1680_ListText(&list, 4, 2, "Hello, bands!\nLine 2", &cp866_8x8, ColorWhite));
+  CHECK(!SSD1680_ListBitmap(&list, 8, 30, 152, 152, girl15_k, girl15_r));
+  CHECK(!SSD1680_ListLine(&list, 0, 295, 175, 190, ColorRed));
+  CHECK(!SSD1680_ListLine(&list, 3, 190, 170, 290, ColorBlack));
+  CHECK(!SSD1680_ListFill(&list, 13, 200, 50, 37, ColorRed));
+  CHECK(!SSD1680_ListText(&list, 90, 250, "Temp 21.5", &cp866_8x16, ColorRed));
+
+  printf("rows  band     cpu        SPI calls  SPI bytes\n");
+  for (uint8_t k = 0; k < sizeof(heights) / sizeof(heights[0]); ++k) {
+    memset(Stub.RAM, 0x55, sizeof(Stub.RAM));
+    Stub_ClearLog();
+    const clock_t start = clock();
+    for (uint8_t i = 0; i < REPEATS; ++i)
+      CHECK(!SSD1680_RenderList(&hepd, &list, band, heights[k], ColorWhite));
+    const double cpu = (double)(clock() - start) / CLOCKS_PER_SEC * 1e6 / REPEATS;
+    printf("%4u  %5u B  %7.1f us  %9u  %9u\n", heights[k], (unsigned)SSD1680_FB_SIZE(176, heights[k], 2), cpu,
+        (unsigned)(Stub.SPI_Calls / REPEATS), (unsigned)(Stub.SPI_Bytes / REPEATS));
+    if (!k)
+      memcpy(image, Stub.RAM, sizeof(image));
+    CHECK(!memcmp(image, Stub.RAM, sizeof(image)));
+  }
+
+  // Spot checks on the full screen band
+  CHECK(image[0][5][20] == 0x00 && image[1][5][20] == 0x00);		// black fill right of the text
+  CHECK(image[0][25][0] == 0xFF && image[1][25][0] == 0x00);		// white background
+  CHECK(image[1][210][3] == 0xFF);									// red fill
+  CHECK(SSD1680_RenderList(&hepd, &list, band, 0, ColorWhite) == HAL_ERROR);
+  return 0;
+}
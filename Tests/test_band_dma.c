@@ -0,0 +1,116 @@
+/*
+ * test_band_dma.c
+ *
+ * Band rendering with SPI DMA: same image as SSD1680_RenderList, rasterization overlapped with transfer
+ * when two buffers are given, and transfer errors or timeouts leave the driver ready with CS released.
+ * Error of a transfer nobody waited for doesn't fail the next one.
+ */
+
+#include "test.h"
+#include "fonts.h"
+
+#define REPEATS 50		/**< Renders per band height for timing */
+
+extern const unsigned char girl15_k[], girl15_r[];
+
+static SSD1680_HandleTypeDef hepd;
+static uint16_t completions;
+static uint16_t failAt;
+
+/**
+ * @brief Report DMA completion, or SPI error on the completion number @ref failAt
+ */
+static void Complete(void) {
+  if (++completions == failAt)
+    SSD1680_SPI_ErrorCallback(&hepd, &Stub_SPI);
+  else
+    SSD1680_SPI_CpltCallback(&hepd, &Stub_SPI);
+}
+
+/**
+ * @brief Get average real time of rendering a list
+ * @param[in] list: display list
+ * @param[in] band0: first band buffer
+ * @param[in] band1: second band buffer or NULL
+ * @param[in] rows: band height
+ * @param[in] dma: non-zero to use SSD1680_RenderList_DMA
+ * @return Time in ns
+ */
+static int64_t Time(const SSD1680_DisplayListTypeDef *list, uint8_t *band0, uint8_t *band1, const uint16_t rows, const uint8_t dma) {
+  const int64_t start = Stub_Now();
+  for (uint8_t i = 0; i < REPEATS; ++i)
+    CHECK(!(dma ? SSD1680_RenderList_DMA(&hepd, list, band0, band1, rows, ColorWhite) : SSD1680_RenderList(&hepd, list, band0, rows, ColorWhite)));
+  return (Stub_Now() - start) / REPEATS;
+}
+
+int main(void) {
+  static const uint16_t heights[] = { 8, 16, 32, 74 };
+  static uint8_t band0[SSD1680_FB_SIZE(176, 296, 2)], band1[SSD1680_FB_SIZE(176, 296, 2)];
+  static uint8_t image[2][STUB_RAM_HEIGHT][STUB_RAM_WIDTH];
+  Test_Handle(&hepd, 2);
+  hepd.SPI_Timeout = 0xFFFFFFFF;
+  CHECK(!SSD1680_Init(&hepd));
+  Stub.DMA_Callback = Complete;
+
+  SSD1680_DrawItemTypeDef items[64];
+  SSD1680_DisplayListTypeDef list = { items, sizeof(items) / sizeof(items[0]), 0 };
+  CHECK(!SSD1680_ListBitmap(&list, 8, 30, 152, 152, girl15_k, girl15_r));
+  for (uint8_t i = 0; i < 40; ++i)
+    CHECK(!SSD1680_ListLine(&list, i * 4, 0, 175 - i * 4, 295, i & 1 ? ColorBlack : ColorRed));
+  for (uint8_t i = 0; i < 12; ++i)
+    CHECK(!SSD1680_ListText(&list, 0, i * 24, "Pipelined band rendering", &cp866_8x16, ColorBlack));
+
+  CHECK(!SSD1680_RenderList(&hepd, &list, band0, 296, ColorWhite));
+  memcpy(image, Stub.RAM, sizeof(image));
+
+  // Simulated SPI clock makes transfer take as long as rendering, timings vary by machine
+  printf("rows  render    transfer  single    ping-pong\n");
+  for (uint8_t k = 0; k < sizeof(heights) / sizeof(heights[0]); ++k) {
+    const uint16_t rows = heights[k];
+    Stub.DMA_NS_Per_Byte = 0;
+    const int64_t render = Time(&list, band0, NULL, rows, 0);
+    const int64_t bytes = 176 / 8 * 296 * 2;
+    Stub.DMA_NS_Per_Byte = render / bytes ? render / bytes : 1;
+    memset(Stub.RAM, 0x55, sizeof(Stub.RAM));
+    const int64_t single = Time(&list, band0, NULL, rows, 1);
+    CHECK(!memcmp(image, Stub.RAM, sizeof(image)));
+    memset(Stub.RAM, 0x55, sizeof(Stub.RAM));
+    const int64_t pingPong = Time(&list, band0, band1, rows, 1);
+    CHECK(!memcmp(image, Stub.RAM, sizeof(image)));
+    printf("%4u  %6u us  %6u us  %6u us  %6u us\n", rows, (unsigned)(render / 1000),
+        (unsigned)(bytes * Stub.DMA_NS_Per_Byte / 1000), (unsigned)(single / 1000), (unsigned)(pingPong / 1000));
+    CHECK(SSD1680_GetState(&hepd) == StateReady && Test_Released());
+  }
+
+  SSD1680_ListClear(&list);
+  CHECK(!SSD1680_ListFill(&list, 0, 0, 176, 40, ColorBlack));
+
+  // SPI error in the middle of the frame is returned, rest of the frame is dropped
+  completions = 0;
+  failAt = 3;
+  CHECK(SSD1680_RenderList_DMA(&hepd, &list, band0, band1, 16, ColorWhite) == HAL_ERROR);
+  CHECK(completions == failAt);
+  CHECK(SSD1680_GetState(&hepd) == StateReady && Test_Released() && !Stub.DMA_Pending);
+  failAt = 0;
+  CHECK(!SSD1680_RenderList_DMA(&hepd, &list, band0, band1, 16, ColorWhite));
+
+  // Failure of a transfer nobody waited for is not reported by the next one
+  completions = 0;
+  failAt = 1;
+  CHECK(!SSD1680_SetRegion_DMA(&hepd, 0, 0, 176, 16, band0, NULL));
+  while (SSD1680_GetState(&hepd) != StateReady)
+    __WFI();
+  CHECK(completions == failAt);
+  failAt = 0;
+  CHECK(!SSD1680_RenderList_DMA(&hepd, &list, band0, band1, 16, ColorWhite));
+
+  // DMA never completes
+  Stub.DMA_NS_Per_Byte = 0;
+  hepd.SPI_Timeout = 10;
+  Stub.Aborts = 0;
+  CHECK(SSD1680_RenderList_DMA(&hepd, &list, band0, band1, 16, ColorWhite) == HAL_TIMEOUT);
+  CHECK(SSD1680_GetState(&hepd) == StateReady && Test_Released() && !Stub.DMA_Pending);
+  CHECK(Stub.Aborts == 1);
+  CHECK(!SSD1680_Send(&hepd, SSD1680_NOP, NULL, 0));
+  return 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * test_burst.c
+ *
+ * Burst partial refresh: analog left on between partial refreshes, powered down by SSD1680_Process after Burst_Idle ms of quiet.
+ */
+
+#include "test.h"
+
+#define POWER_ON 0xC0	/**< Update control 2 bits to enable clock and analog, private to SSD1680.c */
+#define POWER_OFF 0x03	/**< Update control 2 bits to disable analog and clock, private to SSD1680.c */
+#define IDLE 200		/**< Burst_Idle in ms */
+
+int main(void) {
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  hepd.Burst_Idle = IDLE;
+  CHECK(!SSD1680_Init(&hepd));
+
+  // First partial refresh powers up and leaves analog on, the next one neither powers up nor down
+  CHECK(!SSD1680_Refresh(&hepd, PartialRefresh));
+  CHECK((Stub.Sequence & POWER_ON) == POWER_ON && !(Stub.Sequence & POWER_OFF) && hepd.Analog_On);
+  CHECK(!SSD1680_Refresh(&hepd, PartialRefresh));
+  CHECK(!(Stub.Sequence & (POWER_ON | POWER_OFF)) && hepd.Analog_On);
+
+  // Quiet period not over yet
+  Stub_ClearLog();
+  Stub.Tick += IDLE / 2;
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Stub.Log_Size == 0 && hepd.Analog_On);
+
+  Stub.Tick += IDLE / 2;
+  CHECK(!SSD1680_Process(&hepd));
+  Test_Dump("power down");
+  const uint8_t powerDown[] = { SSD1680_UPDATE_CONTROL_2, POWER_OFF, SSD1680_MASTER_ACTIVATION };
+  CHECK(Stub.Log_Size == sizeof(powerDown) && !memcmp(Stub.Log, powerDown, sizeof(powerDown)));
+  CHECK(!hepd.Analog_On);
+  Stub_ClearLog();
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Stub.Log_Size == 0);
+
+  // Full refresh powers down as usual, on demand power down does nothing then
+  CHECK(!SSD1680_Refresh(&hepd, PartialRefresh));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  CHECK((Stub.Sequence & POWER_OFF) == POWER_OFF && !hepd.Analog_On);
+  Stub_ClearLog();
+  CHECK(!SSD1680_PowerDown(&hepd));
+  CHECK(Stub.Log_Size == 0);
+
+  // Disabled: every partial refresh powers down
+  hepd.Burst_Idle = 0;
+  CHECK(!SSD1680_Refresh(&hepd, PartialRefresh));
+  CHECK((Stub.Sequence & POWER_OFF) == POWER_OFF && !hepd.Analog_On);
+  return 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * test_busy.c
+ *
+ * Interrupt driven BUSY handling: SSD1680_Refresh_IT returns right away, SSD1680_Wait sleeps until the falling edge.
+ * Stuck BUSY times out into recovery, failed recovery is reported.
+ */
+
+#include "test.h"
+
+static SSD1680_HandleTypeDef hepd;
+static uint8_t ready;
+
+static void Ready(SSD1680_HandleTypeDef *h) {
+  (void)h;
+  ++ready;
+}
+
+static void Falling(void) {
+  SSD1680_BUSY_EXTI_Callback(&hepd, STUB_BUSY_PIN);
+}
+
+int main(void) {
+  Test_Handle(&hepd, 2);
+  hepd.BUSY_EXTI = 1;
+  hepd.Ready_Callback = Ready;
+  Stub.BUSY_Callback = Falling;
+  CHECK(!SSD1680_Init(&hepd));
+  CHECK(SSD1680_GetState(&hepd) == StateReady);
+
+  ready = 0;
+  Stub_ClearLog();
+  uint32_t start = HAL_GetTick();
+  CHECK(!SSD1680_Refresh_IT(&hepd, FullRefresh));
+  CHECK(HAL_GetTick() == start);
+  CHECK(SSD1680_GetState(&hepd) == StateBusy);
+  CHECK(!SSD1680_Wait(&hepd));
+  printf("EXTI wait: %u ms, %u HAL_Delay calls, %u BUSY reads, %u WFI\n", (unsigned)(HAL_GetTick() - start),
+      (unsigned)Stub.Delays, (unsigned)Stub.Pin_Reads, (unsigned)Stub.WFI_Count);
+  CHECK(HAL_GetTick() - start == Stub.Busy_Time);
+  CHECK(Stub.Delays == 0);
+  CHECK(ready == 1);
+  CHECK(SSD1680_GetState(&hepd) == StateReady);
+
+  // Command sent during refresh waits for it
+  CHECK(!SSD1680_Refresh_IT(&hepd, FullRefresh));
+  start = HAL_GetTick();
+  CHECK(!SSD1680_Send(&hepd, SSD1680_NOP, NULL, 0));
+  CHECK(HAL_GetTick() - start == Stub.Busy_Time);
+  CHECK(ready == 2);
+
+  // Without EXTI the busy period ends when the line is sampled low
+  hepd.BUSY_EXTI = 0;
+  CHECK(!SSD1680_Refresh_IT(&hepd, FullRefresh));
+  while (SSD1680_GetState(&hepd) == StateBusy)
+    ++Stub.Tick;
+  CHECK(ready == 3);
+
+  // Stuck BUSY times out, hardware reset of recovery releases it and the handle is usable again
+  hepd.Auto_Recover = 1;
+  Stub.Busy_Stuck = 1;
+  CHECK(!SSD1680_Refresh_IT(&hepd, FullRefresh));
+  CHECK(SSD1680_Wait(&hepd) == HAL_TIMEOUT);
+  CHECK((hepd.ErrorCode & SSD1680_ERROR_BUSY_TIMEOUT) && !Stub.Busy_Stuck);
+  CHECK(SSD1680_GetState(&hepd) == StateReady);
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+
+  // Stuck through reset, failed recovery is reported
+  Stub.Busy_Stuck = 2;
+  CHECK(!SSD1680_Refresh_IT(&hepd, FullRefresh));
+  CHECK(SSD1680_Wait(&hepd) == HAL_ERROR);
+  Stub.Busy_Stuck = 0;
+  CHECK(!SSD1680_Recover(&hepd));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * test_differential.c
+ *
+ * Differential refresh: the displayed image is copied into secondary (red) RAM bank from the framebuffer
+ * when it mirrors primary (black) RAM bank, and read back from the controller when it doesn't.
+ */
+
+#include "test.h"
+
+#define STRIDE (176 / 8)		/**< Bytes per row */
+
+/**
+ * @brief Check that a band of rows of secondary RAM bank holds the image
+ * @param[in] image: full screen image
+ * @param[in] top: topmost row
+ * @param[in] bottom: row next to the bottommost one
+ * @return Non-zero if every byte matches
+ */
+static uint8_t Previous(const uint8_t *image, const uint16_t top, const uint16_t bottom) {
+  for (uint16_t y = top; y < bottom; ++y)
+    if (memcmp(Stub.RAM[1][y], image + y * STRIDE, STRIDE))
+      return 0;
+  return 1;
+}
+
+/**
+ * @brief Check that a band of rows of secondary RAM bank was read back from the controller
+ * @param[in] top: topmost row
+ * @param[in] bottom: row next to the bottommost one
+ * @return Non-zero if every byte is the received fill value
+ */
+static uint8_t ReadBack(const uint16_t top, const uint16_t bottom) {
+  for (uint16_t y = top; y < bottom; ++y)
+    for (uint8_t x = 0; x < STRIDE; ++x)
+      if (Stub.RAM[1][y][x] != Stub.RX_Fill)
+        return 0;
+  return 1;
+}
+
+int main(void) {
+  static uint8_t data[SSD1680_FB_SIZE(176, 296, 1)];
+  static uint8_t image[STRIDE * 296], line[STRIDE];
+  static SSD1680_FramebufferTypeDef fb;
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 1);
+  hepd.Differential = 1;
+  fb.Data = data;
+  hepd.Framebuffer = &fb;
+  CHECK(!SSD1680_Init(&hepd));
+  for (uint32_t i = 0; i < sizeof(image); ++i)
+    image[i] = i * 13;
+
+  // Whole frame uploaded from the framebuffer is copied from it, nothing is read back
+  CHECK(!SSD1680_ShowFrame(&hepd, image, NULL));
+  const uint32_t bytes = Stub.SPI_Bytes;
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Previous(image, 0, 296));
+  printf("full screen copy %u bytes\n", (unsigned)(Stub.SPI_Bytes - bytes));
+  CHECK(Stub.SPI_Bytes - bytes < sizeof(image) + 32);
+
+  // Changed band is copied from the framebuffer too
+  memset(image + 100 * STRIDE, 0x0F, 8 * STRIDE);
+  CHECK(!SSD1680_ShowFrame(&hepd, image, NULL));
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Previous(image, 0, 296));
+
+  // Rows drawn but not yet uploaded differ from primary RAM bank, those are read back
+  memset(image + 100 * STRIDE, 0xF0, 8 * STRIDE);
+  CHECK(!SSD1680_ShowFrame(&hepd, image, NULL));
+  CHECK(!SSD1680_DrawRect(&hepd, 0, 104, 176, 1, ColorBlack));
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(ReadBack(100, 108));
+
+  // Direct write makes primary RAM bank differ from the framebuffer
+  CHECK(!SSD1680_Flush(&hepd, NULL, NULL));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(!SSD1680_SetRegion(&hepd, 0, 200, 176, 1, line, NULL));
+  CHECK(!SSD1680_Refresh(&hepd, FastPartialRefresh));
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(ReadBack(200, 201));
+
+  // Whole framebuffer uploaded after reset mirrors primary RAM bank again
+  SSD1680_Reset(&hepd);
+  CHECK(!SSD1680_Init(&hepd));
+  CHECK(!SSD1680_ShowFrame(&hepd, image, NULL));
+  memset(Stub.RAM[1], Stub.RX_Fill, sizeof(Stub.RAM[1]));
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Previous(image, 0, 296));
+  return 0;
+}
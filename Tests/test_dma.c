@@ -0,0 +1,92 @@
+/*
+ * test_dma.c
+ *
+ * SSD1680_SetRegion_DMA and SSD1680_GetRegion_DMA: both banks transferred,
+ * secondary bank setup sent by DMA from the completion callback, blocking calls refused meanwhile,
+ * completion reported in dry run too.
+ */
+
+#include "test.h"
+
+static SSD1680_HandleTypeDef hepd;
+static uint8_t done;
+static HAL_StatusTypeDef doneStatus;
+
+static void Transfer(SSD1680_HandleTypeDef *h, HAL_StatusTypeDef status) {
+  (void)h;
+  ++done;
+  doneStatus = status;
+}
+
+static void Complete(void) {
+  SSD1680_SPI_CpltCallback(&hepd, &Stub_SPI);
+}
+
+int main(void) {
+  static uint8_t k[2 * 16], r[2 * 16];
+  Test_Handle(&hepd, 2);
+  hepd.Transfer_Callback = Transfer;
+  CHECK(!SSD1680_Init(&hepd));
+  Stub.DMA_Callback = Complete;
+  for (uint16_t i = 0; i < sizeof(k); ++i) {
+    k[i] = i;
+    r[i] = 0x80 | i;
+  }
+
+  CHECK(!SSD1680_SetRegion_DMA(&hepd, 8, 260, 16, 16, k, r));
+  CHECK(SSD1680_GetState(&hepd) == StateTransmit);
+  CHECK(SSD1680_Send(&hepd, SSD1680_NOP, NULL, 0) == HAL_BUSY);
+  // Black data, then 0x4E, x, 0x4F, y, 0x26 and red data, each its own DMA stage
+  uint8_t stages = 0;
+  const uint32_t polled = Stub.SPI_Calls;
+  while (Stub.DMA_Pending) {
+    ++stages;
+    Stub_DMAComplete();
+    // Nothing is sent by polling from the callback
+    CHECK(Stub.SPI_Calls == polled + stages - 1 + Stub.DMA_Pending);
+  }
+  printf("write: %u DMA stages\n", stages);
+  CHECK(stages == 7);
+  CHECK(done == 1 && doneStatus == HAL_OK);
+  CHECK(SSD1680_GetState(&hepd) == StateReady);
+  CHECK(Test_Released());
+  for (uint16_t y = 0; y < 16; ++y)
+    for (uint8_t x = 0; x < 2; ++x) {
+      CHECK(Stub.RAM[0][260 + y][1 + x] == k[y * 2 + x]);
+      CHECK(Stub.RAM[1][260 + y][1 + x] == r[y * 2 + x]);
+    }
+
+  Stub.RX_Fill = 0x5A;
+  CHECK(!SSD1680_GetRegion_DMA(&hepd, 8, 260, 16, 16, k, r));
+  CHECK(SSD1680_GetState(&hepd) == StateReceive);
+  stages = 0;
+  while (Stub.DMA_Pending) {
+    ++stages;
+    Stub_DMAComplete();
+  }
+  // Black data, then 0x41, option, 0x4E, x, 0x4F, y, 0x27, dummy bytes and red data
+  printf("read: %u DMA stages\n", stages);
+  CHECK(stages == 10);
+  CHECK(done == 2 && doneStatus == HAL_OK);
+  CHECK(k[0] == 0x5A && r[sizeof(r) - 1] == 0x5A);
+  CHECK(Test_Released());
+
+  // Failure in the middle of the chain
+  CHECK(!SSD1680_SetRegion_DMA(&hepd, 0, 0, 16, 16, k, r));
+  Stub_DMAComplete();
+  Stub_DMAComplete();
+  SSD1680_SPI_ErrorCallback(&hepd, &Stub_SPI);
+  CHECK(done == 3 && doneStatus == HAL_ERROR);
+  CHECK(SSD1680_GetState(&hepd) == StateReady);
+  CHECK(Test_Released());
+
+  // Dry run sends nothing, completion is still reported
+  SSD1680_FrameBegin(&hepd, 1);
+  Stub_ClearLog();
+  const uint32_t calls = Stub.SPI_Calls;
+  CHECK(!SSD1680_SetRegion_DMA(&hepd, 0, 0, 16, 16, k, r));
+  CHECK(done == 4 && doneStatus == HAL_OK);
+  CHECK(Stub.SPI_Calls == calls && Stub.Log_Size == 0 && SSD1680_GetState(&hepd) == StateReady);
+  SSD1680_FrameBegin(&hepd, 0);
+  return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * test_fingerprint.c
+ *
+ * Frame fingerprint: identical frame is recognized after a full refresh and after reboot in dry run,
+ * whichever call uploaded it, and nothing is hashed without a fingerprint or dry run.
+ */
+
+#include "test.h"
+
+/**
+ * @brief Upload the frame
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] k: primary (black) image
+ * @param[in] r: secondary (red) image
+ */
+static void Upload(SSD1680_HandleTypeDef *hepd, const uint8_t *k, const uint8_t *r) {
+  CHECK(!SSD1680_SetRegion(hepd, 0, 0, 176, 296, k, r));
+}
+
+int main(void) {
+  static uint8_t k[176 / 8 * 296], r[176 / 8 * 296];
+  static SSD1680_FingerprintTypeDef fingerprint;
+  for (uint32_t i = 0; i < sizeof(k); ++i) {
+    k[i] = i * 7;
+    r[i] = i >> 4;
+  }
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  CHECK(!SSD1680_Init(&hepd));
+
+  // Nothing to compare with, nothing hashed
+  const uint32_t basis = hepd.Frame_Hash;
+  Upload(&hepd, k, r);
+  CHECK(hepd.Frame_Hash == basis);
+
+  hepd.Fingerprint = &fingerprint;
+  Upload(&hepd, k, r);
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  CHECK(fingerprint.Magic == SSD1680_FINGERPRINT_MAGIC);
+
+  // Same frame again: hash restarted by the refresh, no SSD1680_FrameBegin needed
+  Upload(&hepd, k, r);
+  CHECK(SSD1680_FrameUnchanged(&hepd, FullRefresh));
+  Upload(&hepd, k, r);
+  CHECK(SSD1680_FrameUnchanged(&hepd, FastFullRefresh));
+
+  // Reboot: frame rendered in dry run is not sent and matches
+  Test_Handle(&hepd, 2);
+  hepd.Fingerprint = &fingerprint;
+  CHECK(!SSD1680_Init(&hepd));
+  Stub_ClearLog();
+  SSD1680_FrameBegin(&hepd, 1);
+  Upload(&hepd, k, r);
+  CHECK(Stub.Log_Size == 0);
+  CHECK(SSD1680_FrameUnchanged(&hepd, FullRefresh));
+
+  // Planned upload of the same frame hashes the same way
+  const SSD1680_BoxTypeDef screen = { 0, 176, 0, 296 };
+  SSD1680_FrameBegin(&hepd, 1);
+  CHECK(!SSD1680_SetRegions(&hepd, &screen, 1, k, NULL));
+  CHECK(!SSD1680_SetRegions(&hepd, &screen, 1, NULL, r));
+  const uint32_t planned = hepd.Frame_Hash;
+  SSD1680_FrameBegin(&hepd, 1);
+  CHECK(!SSD1680_SetRegion(&hepd, 0, 0, 176, 296, k, NULL));
+  CHECK(!SSD1680_SetRegion(&hepd, 0, 0, 176, 296, NULL, r));
+  CHECK(hepd.Frame_Hash == planned);
+  SSD1680_FrameBegin(&hepd, 0);
+
+  // One byte off
+  k[1000] ^= 0x10;
+  Upload(&hepd, k, r);
+  CHECK(!SSD1680_FrameUnchanged(&hepd, FullRefresh));
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * test_frame.c
+ *
+ * Frame diffing: every pair of first and last changed bytes of a row is found at any position within
+ * the word, for row sizes not multiple of the word and rows not word aligned. SSD1680_ShowFrame refreshes
+ * the band from the first to the last changed row.
+ */
+
+#include "test.h"
+
+/**
+ * @brief Find byte sequence in transmit log
+ * @param[in] bytes: sequence
+ * @param[in] size: sequence size
+ * @return Non-zero if found
+ */
+static uint8_t Find(const uint8_t *bytes, const uint8_t size) {
+  for (uint32_t i = 0; i + size <= Stub.Log_Size; ++i)
+    if (!memcmp(Stub.Log + i, bytes, size))
+      return 1;
+  return 0;
+}
+
+int main(void) {
+  static const uint8_t widths[] = { 8, 16, 24, 32, 40, 56, 120, 176 };
+  static uint8_t data[SSD1680_FB_SIZE(176, 296, 1)];
+  static uint8_t image[SSD1680_FB_SIZE(176, 296, 1)];
+  static SSD1680_FramebufferTypeDef fb;
+  SSD1680_HandleTypeDef hepd;
+  uint32_t changed;
+  uint16_t top, height;
+
+  for (uint8_t k = 0; k < sizeof(widths) / sizeof(widths[0]); ++k) {
+    Test_Handle(&hepd, 1);
+    hepd.Resolution_X = widths[k];
+    fb.Data = data;
+    fb.Dirty_Count[0] = 0;
+    hepd.Framebuffer = &fb;
+    CHECK(!SSD1680_Init(&hepd));
+    const uint8_t stride = widths[k] / 8;
+    memset(data, 0, sizeof(data));
+    memset(image, 0, sizeof(image));
+    CHECK(!SSD1680_Flush(&hepd, NULL, NULL));
+
+    // Every span on a row starting at every offset within the word
+    for (uint8_t first = 0; first < stride; ++first)
+      for (uint8_t last = first; last < stride; ++last) {
+        const uint16_t y = (first * stride + last) % 296;
+        uint8_t *row = image + y * stride;
+        row[first] ^= 0x80 >> (last & 7);
+        row[last] ^= 0x01 << (first & 7);
+        CHECK(!SSD1680_DrawFrame(&hepd, image, NULL, &changed));
+        if (first == last && (0x80 >> (last & 7)) == (0x01 << (first & 7))) {
+          CHECK(!changed && !fb.Dirty_Count[0]);
+          continue;
+        }
+        CHECK(changed == (uint32_t)(last - first + 1));
+        CHECK(fb.Dirty_Count[0] == 1);
+        CHECK(fb.Dirty[0][0].Left == first * 8 && fb.Dirty[0][0].Right == (last + 1) * 8);
+        CHECK(fb.Dirty[0][0].Top == y && fb.Dirty[0][0].Bottom == y + 1);
+        CHECK(!memcmp(data, image, stride * 296));
+        CHECK(!SSD1680_Flush(&hepd, &top, &height));
+        CHECK(top == y && height == 1);
+      }
+    printf("width %3u: spans found\n", widths[k]);
+  }
+
+  // Band of the first to the last changed row is refreshed
+  Test_Handle(&hepd, 1);
+  fb.Dirty_Count[0] = 0;
+  hepd.Framebuffer = &fb;
+  CHECK(!SSD1680_Init(&hepd));
+  memset(image, 0, sizeof(image));
+  CHECK(!SSD1680_ShowFrame(&hepd, image, NULL));
+  image[37 * 22 + 21] = 0x01;
+  image[52 * 22] = 0x80;
+  Stub_ClearLog();
+  CHECK(!SSD1680_ShowFrame(&hepd, image, NULL));
+  const uint8_t band[] = { SSD1680_GATE_SCAN_START, 37, 0, SSD1680_GATE_SCAN, 52 - 37, 0, 0 };
+  CHECK(Find(band, sizeof(band)));
+  CHECK(!memcmp(Stub.RAM[0][37], image + 37 * 22, 22) && !memcmp(Stub.RAM[0][52], image + 52 * 22, 22));
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * test_framebuffer.c
+ *
+ * Framebuffer dirty tracking: a change of any height takes one rectangle, consecutive changed rows of a frame
+ * continue it, overflowing the list loses nothing. SSD1680_ShowFrame refreshes a band for a small change
+ * and the whole screen for a large one.
+ */
+
+#include "test.h"
+
+#define STRIDE (176 / 8)		/**< Bytes per row */
+
+/**
+ * @brief Find command in transmit log
+ * @param[in] command: command byte
+ * @param[out] arg: the first argument
+ * @return Non-zero if found
+ */
+static uint8_t Find(const uint8_t command, uint8_t *arg) {
+  for (uint32_t i = 0; i + 1 < Stub.Log_Size; ++i)
+    if (Stub.Log[i] == command) {
+      *arg = Stub.Log[i + 1];
+      return 1;
+    }
+  return 0;
+}
+
+/**
+ * @brief Check that both RAM banks hold the framebuffer
+ * @param[in] data: framebuffer storage
+ * @return Non-zero if every byte matches
+ */
+static uint8_t Uploaded(const uint8_t *data) {
+  return !memcmp(Stub.RAM[0], data, STRIDE * 296) && !memcmp(Stub.RAM[1], data + STRIDE * 296, STRIDE * 296);
+}
+
+int main(void) {
+  static uint8_t data[SSD1680_FB_SIZE(176, 296, 2)];
+  static uint8_t image[STRIDE * 296];
+  static SSD1680_FramebufferTypeDef fb;
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  fb.Data = data;
+  hepd.Framebuffer = &fb;
+  CHECK(!SSD1680_Init(&hepd));
+  uint16_t top, height;
+  CHECK(!SSD1680_Flush(&hepd, &top, &height));
+  CHECK(Uploaded(data));
+
+  // Full height change is a single byte aligned rectangle
+  CHECK(!SSD1680_DrawRect(&hepd, 10, 0, 30, 296, ColorRed));
+  CHECK(fb.Dirty_Count[0] == 1 && fb.Dirty_Count[1] == 1);
+  CHECK(fb.Dirty[0][0].Left == 8 && fb.Dirty[0][0].Right == 40 && fb.Dirty[0][0].Top == 0 && fb.Dirty[0][0].Bottom == 296);
+  CHECK(!SSD1680_DrawRect(&hepd, 20, 100, 40, 10, ColorBlack));
+  CHECK(fb.Dirty_Count[0] == 1 && fb.Dirty[0][0].Right == 64);
+  const uint32_t bytes = Stub.SPI_Bytes;
+  CHECK(!SSD1680_Flush(&hepd, &top, &height));
+  CHECK(top == 0 && height == 296 && Uploaded(data));
+  CHECK(!fb.Dirty_Count[0] && !fb.Dirty_Count[1]);
+  printf("rectangle upload %u bytes\n", (unsigned)(Stub.SPI_Bytes - bytes));
+  CHECK(Stub.SPI_Bytes - bytes < 2 * 7 * 296 + 64);
+
+  // Changed rows of a frame with overlapping spans continue one rectangle
+  memcpy(image, data, sizeof(image));
+  for (uint16_t y = 50; y < 60; ++y) {
+    image[y * STRIDE + 4] ^= 0x0F;
+    if (!(y & 1))
+      image[y * STRIDE + 3] ^= 0xFF;
+  }
+  uint32_t changed;
+  CHECK(!SSD1680_DrawFrame(&hepd, image, NULL, &changed));
+  CHECK(changed == 15 && fb.Dirty_Count[0] == 1 && !fb.Dirty_Count[1]);
+  CHECK(fb.Dirty[0][0].Left == 24 && fb.Dirty[0][0].Right == 40 && fb.Dirty[0][0].Top == 50 && fb.Dirty[0][0].Bottom == 60);
+  CHECK(!SSD1680_Flush(&hepd, &top, &height));
+  CHECK(top == 50 && height == 10 && Uploaded(data));
+
+  // Changes past the list are merged, none is lost
+  for (uint8_t i = 0; i < SSD1680_FB_RECTS + 8; ++i)
+    CHECK(!SSD1680_DrawPixel(&hepd, (i & 1) ? 170 : 2, i * 7, ColorBlack));
+  CHECK(fb.Dirty_Count[0] == SSD1680_FB_RECTS);
+  CHECK(!SSD1680_Flush(&hepd, &top, &height));
+  CHECK(top == 0 && height == (SSD1680_FB_RECTS + 7) * 7 + 1 && Uploaded(data));
+
+  // Small change refreshes only its band
+  uint8_t arg;
+  memcpy(image, data, sizeof(image));
+  memset(image + 120 * STRIDE, 0x5A, 8 * STRIDE);
+  Stub_ClearLog();
+  CHECK(!SSD1680_ShowFrame(&hepd, image, NULL));
+  CHECK(Find(SSD1680_GATE_SCAN_START, &arg) && arg == 120);
+  CHECK(Find(SSD1680_UPDATE_CONTROL_2, &arg) && (arg & 0x08));
+  CHECK(Uploaded(data));
+
+  // Large change refreshes the whole screen
+  for (uint32_t i = 0; i < sizeof(image); ++i)
+    image[i] = ~image[i];
+  Stub_ClearLog();
+  CHECK(!SSD1680_ShowFrame(&hepd, image, NULL));
+  CHECK(!Find(SSD1680_GATE_SCAN_START, &arg));
+  CHECK(Find(SSD1680_UPDATE_CONTROL_2, &arg) && !(arg & 0x08));
+  CHECK(Stub.Gate_Lines == 296 && Uploaded(data));
+  return 0;
+}
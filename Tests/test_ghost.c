@@ -0,0 +1,106 @@
+/*
+ * test_ghost.c
+ *
+ * Ghosting heatmap: AutoRefresh picks the cheapest mode within Ghost_Budget, falls back to full refresh of whole tiles,
+ * SSD1680_Process cleans overworked tiles after Clean_Idle ms of quiet unless a requested refresh is pending.
+ * Without the heatmap AutoRefresh always picks full refresh.
+ */
+
+#include "test.h"
+
+#define TILE SSD1680_GHOST_TILE_ROWS
+#define IDLE 1000		/**< Clean_Idle in ms */
+
+/**
+ * @brief Find gate scan start in transmit log
+ * @details Takes the first one, the full screen range restored after the band comes later.
+ * @return Topmost row of the refresh or -1 if not sent
+ */
+static int32_t Start(void) {
+  for (uint32_t i = 0; i + 2 < Stub.Log_Size; ++i)
+    if (Stub.Log[i] == SSD1680_GATE_SCAN_START)
+      return Stub.Log[i + 1] | Stub.Log[i + 2] << 8;
+  return -1;
+}
+
+int main(void) {
+  static SSD1680_GhostMapTypeDef ghost;
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  hepd.Ghost = &ghost;
+  hepd.Ghost_Budget = 4;
+  CHECK(!SSD1680_Init(&hepd));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+
+  // Fast partial twice, then the tile is over budget for any partial refresh
+  CHECK(!SSD1680_RefreshRegion(&hepd, 2 * TILE + 4, 8, AutoRefresh));
+  CHECK(Stub.Sequence == FastPartialRefresh && ghost.Level[2] == 2);
+  CHECK(!SSD1680_RefreshRegion(&hepd, 2 * TILE + 4, 8, AutoRefresh));
+  CHECK(Stub.Sequence == FastPartialRefresh && ghost.Level[2] == 4);
+  Stub_ClearLog();
+  CHECK(!SSD1680_RefreshRegion(&hepd, 2 * TILE + 4, 8, AutoRefresh));
+  CHECK(Stub.Sequence == FullRefresh && Start() == 2 * TILE && !ghost.Level[2]);
+
+  // Slow partial refresh adds 1, band across two tiles charges both
+  CHECK(!SSD1680_RefreshRegion(&hepd, 5 * TILE - 4, 8, PartialRefresh));
+  CHECK(ghost.Level[4] == 1 && ghost.Level[5] == 1);
+  hepd.Ghost_Budget = 2;
+  CHECK(!SSD1680_RefreshRegion(&hepd, 5 * TILE - 4, 8, AutoRefresh));
+  CHECK(Stub.Sequence == PartialRefresh && ghost.Level[4] == 2 && ghost.Level[5] == 2);
+
+  // Full refresh clears only tiles it covers entirely
+  CHECK(!SSD1680_RefreshRegion(&hepd, 4 * TILE + 2, 2 * TILE, FullRefresh));
+  CHECK(ghost.Level[4] == 2 && !ghost.Level[5]);
+
+  // Last tile takes the rows beyond the heatmap
+  CHECK(!SSD1680_RefreshRegion(&hepd, 290, 6, FastPartialRefresh));
+  CHECK(ghost.Level[SSD1680_GHOST_TILES - 1] == 2);
+
+  printf("heatmap:");
+  for (uint8_t tile = 0; tile < SSD1680_GHOST_TILES; ++tile)
+    printf(" %u", ghost.Level[tile]);
+  printf("\n");
+
+  // Idle cleaning spans tiles at Ghost_Clean level or above
+  hepd.Ghost_Clean = 2;
+  hepd.Clean_Idle = IDLE;
+  Stub_ClearLog();
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Stub.Log_Size == 0);
+  Stub.Tick += IDLE;
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(SSD1680_Wait(&hepd) == HAL_OK);
+  CHECK(Stub.Sequence == FullRefresh && Start() == 4 * TILE);
+  for (uint8_t tile = 0; tile < SSD1680_GHOST_TILES; ++tile)
+    CHECK(!ghost.Level[tile]);
+  // Cleaning was a band refresh, only the full screen gate scan range is restored after it
+  Stub_ClearLog();
+  Stub.Tick += IDLE;
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Start() == 0 && Stub.Sequence == FullRefresh && hepd.Analog_On == 0);
+  Stub_ClearLog();
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Stub.Log_Size == 0);
+
+  // Requested refresh not due yet holds off both cleaning and power down
+  hepd.Burst_Idle = IDLE;
+  hepd.Debounce = 2 * IDLE;
+  CHECK(!SSD1680_RefreshRegion(&hepd, 2 * TILE, 8, FastPartialRefresh));
+  CHECK(ghost.Level[2] == 2 && hepd.Analog_On);
+  CHECK(!SSD1680_RequestRefresh(&hepd, 100, 8, FastPartialRefresh, 0));
+  Stub_ClearLog();
+  Stub.Tick += IDLE;
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(Stub.Log_Size == 0 && hepd.Analog_On && ghost.Level[2] == 2);
+  Stub.Tick += IDLE;
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(SSD1680_Wait(&hepd) == HAL_OK);
+  CHECK(Start() == 100 && !hepd.Sched_Pending);
+
+  // Untracked ghosting is never tolerated
+  hepd.Ghost = NULL;
+  Stub_ClearLog();
+  CHECK(!SSD1680_RefreshRegion(&hepd, 2 * TILE, 8, AutoRefresh));
+  CHECK(Stub.Sequence == FullRefresh && Start() == 2 * TILE);
+  return 0;
+}
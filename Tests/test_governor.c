@@ -0,0 +1,61 @@
+/*
+ * test_governor.c
+ *
+ * Energy governor: red skipped, then downgraded, then deferred with HAL_BUSY even for blocking refresh.
+ * Statistics count only refreshes actually started, pending urgent request doesn't let direct refresh overdraw.
+ */
+
+#include "test.h"
+
+#define BUDGET 30000	/**< Energy budget of the window */
+
+int main(void) {
+  // Full refresh of every row costs 2000 + (40 + 25) * 296 = 21240 with red, fast partial one 2000 + 12 * 296 = 5552 without
+  static const SSD1680_EnergyModelTypeDef model = { 2000, 40, 30, 20, 12, 25 };
+  static SSD1680_EnergyLedgerTypeDef ledger;
+  SSD1680_HandleTypeDef hepd;
+  SSD1680_GovernorStatsTypeDef stats;
+  Test_Handle(&hepd, 2);
+  CHECK(!SSD1680_Init(&hepd));
+  hepd.Energy_Model = &model;
+  hepd.Energy_Ledger = &ledger;
+  hepd.Energy_Budget = BUDGET;
+  hepd.Energy_Window = 3600000;
+
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  SSD1680_GetGovernorStats(&hepd, &stats);
+  CHECK(stats.Allowed == 1 && SSD1680_EnergyRemaining(&hepd) == BUDGET - 21240);
+
+  // Red skipped to fit, the display is left busy
+  CHECK(!SSD1680_Refresh_IT(&hepd, FastPartialRefresh));
+  SSD1680_GetGovernorStats(&hepd, &stats);
+  CHECK(stats.Red_Skipped == 1 && SSD1680_EnergyRemaining(&hepd) == BUDGET - 21240 - 5552);
+  CHECK(SSD1680_GetState(&hepd) == StateBusy);
+
+  // Urgent request waits for the display, direct blocking refresh meanwhile is deferred rather than overdrawing
+  CHECK(!SSD1680_RequestRefresh(&hepd, 0, 296, FastPartialRefresh, 1));
+  CHECK(hepd.Sched_Pending);
+  Stub_ClearLog();
+  CHECK(SSD1680_Refresh(&hepd, FullRefresh) == HAL_BUSY);
+  CHECK(Stub.Log_Size == 0);
+  SSD1680_GetGovernorStats(&hepd, &stats);
+  printf("deferred: allowed %u, red skipped %u, downgraded %u, deferred %u, overdrawn %u\n", (unsigned)stats.Allowed,
+      (unsigned)stats.Red_Skipped, (unsigned)stats.Downgraded, (unsigned)stats.Deferred, (unsigned)stats.Overdrawn);
+  CHECK(stats.Deferred == 1 && stats.Red_Skipped == 1 && !stats.Downgraded && !stats.Overdrawn);
+
+  // Urgent request is started beyond the budget
+  CHECK(!SSD1680_Wait(&hepd));
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(!hepd.Sched_Pending && SSD1680_GetState(&hepd) == StateBusy);
+  SSD1680_GetGovernorStats(&hepd, &stats);
+  CHECK(stats.Overdrawn == 1 && stats.Red_Skipped == 2 && !stats.Downgraded && stats.Deferred == 1);
+  CHECK(!SSD1680_EnergyRemaining(&hepd));
+  CHECK(!SSD1680_Wait(&hepd));
+
+  // Window passed, the budget is back
+  Stub.Tick += hepd.Energy_Window;
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  SSD1680_GetGovernorStats(&hepd, &stats);
+  CHECK(stats.Allowed == 2);
+  return 0;
+}
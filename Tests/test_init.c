@@ -0,0 +1,42 @@
+/*
+ * test_init.c
+ *
+ * Table-driven initialization: one hardware reset, no fixed delays beyond the reset pulse and no LUT load before the first refresh.
+ */
+
+#include "test.h"
+
+#define LOAD_LUT 0x10	/**< Update control 2 bit to load LUT, private to SSD1680.c */
+
+static SSD1680_HandleTypeDef hepd;
+
+static void Falling(void) {
+  SSD1680_BUSY_EXTI_Callback(&hepd, STUB_BUSY_PIN);
+}
+
+int main(void) {
+  static uint8_t frame[176 / 8 * 296];
+  Test_Handle(&hepd, 2);
+  // Waits for BUSY sleep until the falling edge, so HAL_Delay is only used for fixed delays
+  hepd.BUSY_EXTI = 1;
+  Stub.BUSY_Callback = Falling;
+  const uint32_t start = HAL_GetTick();
+  CHECK(!SSD1680_Init(&hepd));
+  const uint32_t init = HAL_GetTick() - start;
+  const uint32_t delays = Stub.Delays;
+  CHECK(!SSD1680_SetRegion(&hepd, 0, 0, 176, 296, frame, NULL));
+  printf("init %u ms, %u HAL_Delay calls, first RAM write %u ms after reset\n",
+      (unsigned)init, (unsigned)delays, (unsigned)hepd.Boot_Duration);
+  // Reset pulse is the only fixed delay
+  CHECK(delays == 2);
+  // Both busy periods of reset are waited on, there is no time to load a LUT
+  CHECK(init >= 2 * STUB_RESET_TIME && init < STUB_REFRESH_TIME);
+  CHECK(hepd.Boot_Duration && hepd.Boot_Duration <= HAL_GetTick() - start);
+
+  // LUT is loaded by the first refresh
+  Stub_ClearLog();
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  CHECK(Stub.Log_Size >= 3 && Stub.Log[Stub.Log_Size - 3] == SSD1680_UPDATE_CONTROL_2);
+  CHECK(Stub.Log[Stub.Log_Size - 2] & LOAD_LUT);
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * test_invert.c
+ *
+ * Hardware inversion: single update control 1 write, RAM left intact, kept by refreshes and recovery.
+ */
+
+#include "test.h"
+
+#define INVERSE_K 0x08	/**< Update control 1 bit to invert black RAM bank, private to SSD1680.c */
+#define INVERSE_R 0x80	/**< Update control 1 bit to invert red RAM bank, private to SSD1680.c */
+
+/**
+ * @brief Get update control 1 sent since the log was cleared
+ * @return First argument of the last update control 1 write or 0 if not sent
+ */
+static uint8_t Control1(void) {
+  uint8_t value = 0;
+  for (uint32_t i = 0; i + 2 < Stub.Log_Size; ++i)
+    if (Stub.Log[i] == SSD1680_UPDATE_CONTROL_1)
+      value = Stub.Log[i + 1];
+  return value;
+}
+
+int main(void) {
+  static uint8_t image[2][STUB_RAM_HEIGHT][STUB_RAM_WIDTH];
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  CHECK(!SSD1680_Init(&hepd));
+  CHECK(!SSD1680_Checker(&hepd));
+  memcpy(image, Stub.RAM, sizeof(image));
+
+  Stub_ClearLog();
+  CHECK(!SSD1680_Invert(&hepd, RAMBlack, 1));
+  Test_Dump("invert black");
+  CHECK(Stub.Log_Size == 3 && Control1() == INVERSE_K);
+  CHECK(!memcmp(image, Stub.RAM, sizeof(image)));
+
+  // Already inverted
+  Stub_ClearLog();
+  CHECK(!SSD1680_Invert(&hepd, RAMBlack, 1));
+  CHECK(Stub.Log_Size == 0);
+
+  Stub_ClearLog();
+  CHECK(!SSD1680_Invert(&hepd, RAMRed, 1));
+  CHECK(Control1() == (INVERSE_K | INVERSE_R));
+
+  // Refreshes keep the inversion
+  Stub_ClearLog();
+  CHECK(!SSD1680_RefreshRegion(&hepd, 40, 32, PartialRefresh));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  CHECK(!Control1() || (Control1() & (INVERSE_K | INVERSE_R)) == (INVERSE_K | INVERSE_R));
+
+  // So does reinitialization after a stuck display
+  Stub_ClearLog();
+  CHECK(!SSD1680_Recover(&hepd));
+  CHECK((Control1() & (INVERSE_K | INVERSE_R)) == (INVERSE_K | INVERSE_R));
+
+  Stub_ClearLog();
+  CHECK(!SSD1680_Invert(&hepd, RAMBlack, 0));
+  CHECK(!SSD1680_Invert(&hepd, RAMRed, 0));
+  CHECK(!(Control1() & (INVERSE_K | INVERSE_R)));
+  return 0;
+}
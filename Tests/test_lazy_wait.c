@@ -0,0 +1,47 @@
+/*
+ * test_lazy_wait.c
+ *
+ * Lazy_Wait: rendering of the next frame overlaps refresh of the previous one.
+ */
+
+#include "test.h"
+
+#define FRAMES 5		/**< Frames per run */
+#define RENDER_TIME 60	/**< Simulated rendering time per frame in ms */
+
+/**
+ * @brief Show frames rendered by the MCU
+ * @param[in] lazy: Lazy_Wait setting
+ * @param[out] waited: time blocked in SSD1680_Wait in ms
+ * @return Total time in ms
+ */
+static uint32_t Run(const uint8_t lazy, uint32_t *waited) {
+  static uint8_t frame[176 / 8 * 296];
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  hepd.Lazy_Wait = lazy;
+  CHECK(!SSD1680_Init(&hepd));
+  CHECK(!SSD1680_Wait(&hepd));
+  memset(&hepd.Stats, 0, sizeof(hepd.Stats));
+  const uint32_t start = HAL_GetTick();
+  for (uint8_t i = 0; i < FRAMES; ++i) {
+    Stub.Tick += RENDER_TIME;
+    CHECK(!SSD1680_SetRegion(&hepd, 0, 0, 176, 296, frame, NULL));
+    CHECK(!SSD1680_Refresh(&hepd, FastFullRefresh));
+  }
+  CHECK(!SSD1680_Wait(&hepd));
+  *waited = hepd.Stats.Wait_Time;
+  return HAL_GetTick() - start;
+}
+
+int main(void) {
+  uint32_t blockingWait, lazyWait;
+  const uint32_t blocking = Run(0, &blockingWait);
+  const uint32_t lazy = Run(1, &lazyWait);
+  printf("%u frames: blocking %u ms (waited %u ms), lazy %u ms (waited %u ms)\n", FRAMES,
+      (unsigned)blocking, (unsigned)blockingWait, (unsigned)lazy, (unsigned)lazyWait);
+  // Every frame but the first hides its rendering behind the previous refresh
+  CHECK(lazy + (FRAMES - 1) * RENDER_TIME <= blocking);
+  CHECK(lazyWait < blockingWait);
+  return 0;
+}
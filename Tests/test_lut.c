@@ -0,0 +1,79 @@
+/*
+ * test_lut.c
+ *
+ * Custom LUT profiles: picked by temperature band for partial refresh, uploaded only when the band changes,
+ * dropped by a refresh loading the OTP LUT.
+ */
+
+#include "test.h"
+
+#define LOAD_BITS 0x30	/**< Update control 2 bits to load temperature and LUT, private to SSD1680.c */
+
+/**
+ * @brief Count command in transmit log
+ * @details Counts every matching byte, so the command must not appear among arguments.
+ */
+static uint8_t Count(const uint8_t command) {
+  uint8_t count = 0;
+  for (uint32_t i = 0; i < Stub.Log_Size; ++i)
+    count += Stub.Log[i] == command;
+  return count;
+}
+
+/**
+ * @brief Refresh with a fresh transmit log
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] mode: refresh mode
+ */
+static void Refresh(SSD1680_HandleTypeDef *hepd, const enum SSD1680_RefreshMode mode) {
+  Stub_ClearLog();
+  CHECK(!SSD1680_Refresh(hepd, mode));
+}
+
+int main(void) {
+  static SSD1680_LUTProfileTypeDef profiles[2] = {
+    { "cold", -20, 15, { 0 }, 0x22, 0x17, { 0x41, 0xA8, 0x3C }, 0x50 },
+    { "warm", 16, 50, { 0 }, 0x22, 0x17, { 0x41, 0xA8, 0x3C }, 0x36 },
+  };
+  memset(profiles[0].LUT, 0x11, SSD1680_LUT_SIZE);
+  memset(profiles[1].LUT, 0x22, SSD1680_LUT_SIZE);
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  hepd.Temp_Interval = 60000;
+  hepd.LUT_Profiles = profiles;
+  hepd.LUT_Profile_Count = 2;
+  CHECK(!SSD1680_Init(&hepd));
+
+  // Sensor reads 25 °C: warm profile uploaded, controller loads neither temperature nor LUT
+  Refresh(&hepd, PartialRefresh);
+  CHECK(Count(SSD1680_READ_TEMP) == 1 && Count(SSD1680_WRITE_LUT) == 1);
+  CHECK(hepd.LUT_Profile == &profiles[1] && !(Stub.Sequence & LOAD_BITS));
+  Refresh(&hepd, PartialRefresh);
+  CHECK(!Count(SSD1680_WRITE_LUT) && !(Stub.Sequence & LOAD_BITS));
+
+  // Colder: other profile, only voltages that differ are resent
+  Stub.Temp = 5;
+  Stub.Tick += hepd.Temp_Interval;
+  Refresh(&hepd, PartialRefresh);
+  CHECK(Count(SSD1680_WRITE_LUT) == 1 && Count(SSD1680_VCOM_VOLTAGE) == 1);
+  CHECK(!Count(SSD1680_GATE_VOLTAGE) && !Count(SSD1680_SOURCE_VOLTAGE));
+  CHECK(hepd.LUT_Profile == &profiles[0]);
+
+  // Full refresh loads OTP LUT, so the profile is uploaded again
+  Refresh(&hepd, FullRefresh);
+  CHECK((Stub.Sequence & LOAD_BITS) && !hepd.LUT_Profile);
+  Refresh(&hepd, PartialRefresh);
+  CHECK(Count(SSD1680_WRITE_LUT) == 1 && hepd.LUT_Profile == &profiles[0]);
+
+  // No band for the temperature: OTP LUT
+  Stub.Temp = 60;
+  Stub.Tick += hepd.Temp_Interval;
+  Refresh(&hepd, PartialRefresh);
+  CHECK(!Count(SSD1680_WRITE_LUT) && (Stub.Sequence & LOAD_BITS));
+
+  profiles[0].Temp_Min = 30;
+  CHECK(SSD1680_WriteLUT(&hepd, &profiles[0]) == HAL_ERROR);
+  memset(profiles[1].LUT, 0, SSD1680_LUT_SIZE);
+  CHECK(SSD1680_WriteLUT(&hepd, &profiles[1]) == HAL_ERROR);
+  return 0;
+}
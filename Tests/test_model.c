@@ -0,0 +1,69 @@
+/*
+ * test_model.c
+ *
+ * Refresh duration model: prediction converges to observed busy period after the panel slows down,
+ * keyed on cached or supplied temperature and not on SSD1680_ReadTemp.
+ */
+
+#include "test.h"
+
+#define SLOWDOWN 80		/**< Extra busy time of every refresh after the panel slowed down in ms */
+
+static SSD1680_HandleTypeDef hepd;
+
+static void Falling(void) {
+  SSD1680_BUSY_EXTI_Callback(&hepd, STUB_BUSY_PIN);
+}
+
+/**
+ * @brief Refresh full screen and wait for it
+ * @param[in] extra: time in ms added to the busy period of the stub
+ * @return Predicted duration before the refresh in ms
+ */
+static uint32_t Refresh(const uint32_t extra) {
+  const uint32_t predicted = SSD1680_PredictRefresh(&hepd, 0, 296, FullRefresh);
+  CHECK(!SSD1680_Refresh_IT(&hepd, FullRefresh));
+  CHECK(hepd.Busy_Expected == predicted);
+  Stub.Busy_Until += extra;
+  Stub.Busy_Time += extra;
+  CHECK(!SSD1680_Wait(&hepd));
+  CHECK(hepd.Busy_Duration == Stub.Busy_Time);
+  return predicted;
+}
+
+int main(void) {
+  static SSD1680_RefreshModelTypeDef model;
+  Test_Handle(&hepd, 2);
+  hepd.Refresh_Model = &model;
+  // Busy period ends exactly on the falling edge
+  hepd.BUSY_EXTI = 1;
+  Stub.BUSY_Callback = Falling;
+  CHECK(!SSD1680_Init(&hepd));
+
+  // Unknown until the first refresh, then learned from it
+  CHECK(!SSD1680_PredictRefresh(&hepd, 0, 296, FullRefresh));
+  Refresh(0);
+  CHECK(SSD1680_PredictRefresh(&hepd, 0, 296, FullRefresh) == hepd.Busy_Duration);
+
+  // Slower panel is followed step by step, within rounding of the smoothing
+  uint32_t error = SLOWDOWN;
+  printf("refresh  predicted  observed\n");
+  for (uint8_t i = 0; i < 40; ++i) {
+    const uint32_t predicted = Refresh(SLOWDOWN);
+    printf("%7u  %9u  %8u\n", i, (unsigned)predicted, (unsigned)hepd.Busy_Duration);
+    CHECK(predicted <= hepd.Busy_Duration && hepd.Busy_Duration - predicted <= error);
+    error = hepd.Busy_Duration - predicted;
+  }
+  const uint32_t converged = SSD1680_PredictRefresh(&hepd, 0, 296, FullRefresh);
+  CHECK(hepd.Busy_Duration - converged < (1 << SSD1680_MODEL_SHIFT));
+
+  // Reading the sensor directly doesn't move the model to another temperature
+  Stub.Temp = -10;
+  SSD1680_ReadTemp(&hepd);
+  CHECK(SSD1680_PredictRefresh(&hepd, 0, 296, FullRefresh) == converged);
+
+  // Supplied temperature does
+  SSD1680_SetTemp(&hepd, -10);
+  CHECK(!SSD1680_PredictRefresh(&hepd, 0, 296, FullRefresh));
+  return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * test_plan.c
+ *
+ * Upload planning: merged rectangles cost no more than uploading each one or their bounding box,
+ * and SSD1680_SetRegions writes every requested byte.
+ */
+
+#include "test.h"
+
+#define TRIALS 200		/**< Random rectangle sets per pattern */
+
+/**
+ * @brief Get cost of rectangle upload the way the planner counts it
+ * @param[in] box: rectangle
+ * @return Cost in bytes of payload
+ */
+static uint32_t Cost(const SSD1680_BoxTypeDef *box) {
+  const uint32_t left = box->Left & ~7, right = (box->Right + 7) & ~7;
+  return SSD1680_FLUSH_OVERHEAD + (right - left) / 8 * (box->Bottom - box->Top);
+}
+
+/**
+ * @brief Check that a byte of primary RAM bank matches the image
+ */
+static uint8_t Written(const uint8_t *image, const uint8_t column, const uint16_t row) {
+  return Stub.RAM[0][row][column] == image[row * 176 / 8 + column];
+}
+
+int main(void) {
+  static const char *names[] = { "small rects", "medium rects", "full rows" };
+  static uint8_t image[176 / 8 * 296];
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 1);
+  CHECK(!SSD1680_Init(&hepd));
+  srand(1);
+  for (uint8_t pattern = 0; pattern < 3; ++pattern) {
+    uint32_t each = 0, bbox = 0, plan = 0, planned = 0;
+    for (uint16_t trial = 0; trial < TRIALS; ++trial) {
+      const uint8_t count = 2 + rand() % (SSD1680_PLAN_BOXES - 2);
+      SSD1680_BoxTypeDef boxes[SSD1680_PLAN_BOXES], merged[SSD1680_PLAN_BOXES];
+      SSD1680_BoxTypeDef bounds = { 255, 0, 0xFFFF, 0 };
+      for (uint8_t i = 0; i < count; ++i) {
+        const uint8_t w = pattern == 0 ? 8 + rand() % 24 : pattern == 1 ? 8 + rand() % 80 : 176;
+        const uint16_t h = pattern == 0 ? 1 + rand() % 16 : pattern == 1 ? 1 + rand() % 60 : 1 + rand() % 4;
+        const uint8_t x = rand() % (176 - w + 1);
+        const uint16_t y = rand() % (296 - h + 1);
+        boxes[i] = (SSD1680_BoxTypeDef){ x, x + w, y, y + h };
+        bounds.Left = x < bounds.Left ? x : bounds.Left;
+        bounds.Right = x + w > bounds.Right ? x + w : bounds.Right;
+        bounds.Top = y < bounds.Top ? y : bounds.Top;
+        bounds.Bottom = y + h > bounds.Bottom ? y + h : bounds.Bottom;
+        each += Cost(&boxes[i]);
+      }
+      bbox += Cost(&bounds);
+      memcpy(merged, boxes, sizeof(boxes));
+      const uint8_t n = SSD1680_PlanRegions(&hepd, merged, count);
+      CHECK(n >= 1 && n <= count);
+      for (uint8_t i = 0; i < n; ++i)
+        plan += Cost(&merged[i]);
+      planned += n;
+
+      for (uint32_t i = 0; i < sizeof(image); ++i)
+        image[i] = rand();
+      CHECK(!SSD1680_SetRegions(&hepd, boxes, count, image, NULL));
+      for (uint8_t i = 0; i < count; ++i)
+        for (uint16_t row = boxes[i].Top; row < boxes[i].Bottom; ++row)
+          for (uint8_t column = boxes[i].Left / 8; column < (boxes[i].Right + 7) / 8; ++column)
+            CHECK(Written(image, column, row));
+    }
+    printf("%s: each %u, bounding box %u, plan %u bytes (%.1f rectangles)\n", names[pattern],
+        (unsigned)each, (unsigned)bbox, (unsigned)plan, (double)planned / TRIALS);
+    CHECK(plan <= each && plan <= bbox);
+  }
+  CHECK(SSD1680_SetRegions(&hepd, NULL, SSD1680_PLAN_BOXES + 1, image, NULL) == HAL_ERROR);
+  return 0;
+}
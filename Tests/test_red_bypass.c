@@ -0,0 +1,62 @@
+/*
+ * test_red_bypass.c
+ *
+ * Red channel bypass: set in update control 1 while the red RAM bank is unchanged since the last refresh.
+ */
+
+#include "test.h"
+
+#define BYPASS_R 0x40	/**< Update control 1 bit to treat red RAM bank as 0, private to SSD1680.c */
+
+static uint8_t control1;
+
+/**
+ * @brief Track update control 1 sent since the log was cleared
+ * @details Value is kept in @ref control1 since the shadow cache drops unchanged writes.
+ */
+static void Track(void) {
+  for (uint32_t i = 0; i + 2 < Stub.Log_Size; ++i)
+    if (Stub.Log[i] == SSD1680_UPDATE_CONTROL_1)
+      control1 = Stub.Log[i + 1];
+  Stub_ClearLog();
+}
+
+int main(void) {
+  static uint8_t k[176 / 8 * 8], r[176 / 8 * 8];
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  hepd.Red_Bypass = 1;
+  CHECK(!SSD1680_Init(&hepd));
+
+  // Freshly reset controller: red bank content is unknown
+  Track();
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  Track();
+  CHECK(!(control1 & BYPASS_R));
+
+  // Only black written since
+  CHECK(!SSD1680_SetRegion(&hepd, 0, 0, 176, 8, k, NULL));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  Track();
+  CHECK(control1 & BYPASS_R);
+
+  // Red written, by data or by pattern fill
+  CHECK(!SSD1680_SetRegion(&hepd, 0, 0, 176, 8, k, r));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  Track();
+  CHECK(!(control1 & BYPASS_R));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  Track();
+  CHECK(control1 & BYPASS_R);
+  CHECK(!SSD1680_Clear(&hepd, ColorWhite));
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  Track();
+  CHECK(!(control1 & BYPASS_R));
+
+  // Disabled
+  hepd.Red_Bypass = 0;
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  Track();
+  CHECK(!(control1 & BYPASS_R));
+  return 0;
+}
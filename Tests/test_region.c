@@ -0,0 +1,92 @@
+/*
+ * test_region.c
+ *
+ * Region limited refresh: gate scan range programmed for the band as gate lines minus one,
+ * full screen range restored after the band, refresh time against band height.
+ */
+
+#include "test.h"
+
+/**
+ * @brief Find command in transmit log
+ * @details Takes the first matching byte, so the command must come before any argument equal to it.
+ * @param[in] command: command byte
+ * @param[out] args: arguments
+ * @param[in] size: number of arguments to copy
+ * @return Non-zero if found
+ */
+static uint8_t Find(const uint8_t command, uint8_t *args, const uint8_t size) {
+  for (uint32_t i = 0; i + size < Stub.Log_Size; ++i)
+    if (Stub.Log[i] == command) {
+      memcpy(args, Stub.Log + i + 1, size);
+      return 1;
+    }
+  return 0;
+}
+
+static SSD1680_HandleTypeDef hepd;
+
+static void Falling(void) {
+  SSD1680_BUSY_EXTI_Callback(&hepd, STUB_BUSY_PIN);
+}
+
+int main(void) {
+  static const uint16_t heights[] = { 8, 16, 32, 74, 148, 296 };
+  Test_Handle(&hepd, 2);
+  // Busy period ends exactly on the falling edge
+  hepd.BUSY_EXTI = 1;
+  Stub.BUSY_Callback = Falling;
+  CHECK(!SSD1680_Init(&hepd));
+  uint8_t args[3];
+
+  // Driver output control takes the number of gate lines minus one
+  Stub_ClearLog();
+  CHECK(!SSD1680_RefreshRegion(&hepd, 40, 32, PartialRefresh));
+  Test_Dump("band 40+32");
+  CHECK(Find(SSD1680_GATE_SCAN_START, args, 2) && args[0] == 40 && args[1] == 0);
+  CHECK(Find(SSD1680_GATE_SCAN, args, 3) && args[0] == 31 && args[1] == 0);
+  CHECK(hepd.Busy_Duration == Stub.Busy_Time && Stub.Busy_Time == STUB_TEMP_TIME + STUB_LUT_TIME + STUB_REFRESH_TIME * 32 / 296);
+
+  // Full screen range is restored once the band is done
+  const uint8_t restore[] = { SSD1680_GATE_SCAN_START, 0, 0, SSD1680_GATE_SCAN, 0x27, 0x01, 0x00 };
+  CHECK(Stub.Log_Size >= sizeof(restore) && !memcmp(Stub.Log + Stub.Log_Size - sizeof(restore), restore, sizeof(restore)));
+  CHECK(Stub.Gate_Lines == 296);
+
+  // Full screen refresh finds the range already there
+  Stub_ClearLog();
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  Test_Dump("full");
+  CHECK(!Find(SSD1680_GATE_SCAN_START, args, 2) && !Find(SSD1680_GATE_SCAN, args, 3));
+  CHECK(Stub.Busy_Time == STUB_LUT_TIME + STUB_TEMP_TIME + STUB_REFRESH_TIME);
+
+  // Non-blocking band refresh leaves the range to SSD1680_Process
+  CHECK(!SSD1680_RefreshRegion_IT(&hepd, 8, 16, PartialRefresh));
+  CHECK(Stub.Gate_Lines == 16);
+  CHECK(!SSD1680_Wait(&hepd));
+  Stub_ClearLog();
+  CHECK(!SSD1680_Process(&hepd));
+  CHECK(!memcmp(Stub.Log, restore, sizeof(restore)) && Stub.Gate_Lines == 296);
+
+  // Restored by the full screen refresh itself when there was no chance before
+  hepd.Lazy_Wait = 1;
+  CHECK(!SSD1680_RefreshRegion(&hepd, 8, 16, PartialRefresh));
+  Stub_ClearLog();
+  CHECK(!SSD1680_Refresh(&hepd, FullRefresh));
+  CHECK(Find(SSD1680_GATE_SCAN_START, args, 2) && args[0] == 0 && args[1] == 0);
+  CHECK(Find(SSD1680_GATE_SCAN, args, 3) && args[0] == 0x27 && args[1] == 0x01);
+  CHECK(!SSD1680_Wait(&hepd));
+  hepd.Lazy_Wait = 0;
+
+  // Display stage of the simulated panel takes time proportional to the gate lines driven
+  printf("rows  refresh\n");
+  uint32_t previous = 0;
+  for (uint8_t k = 0; k < sizeof(heights) / sizeof(heights[0]); ++k) {
+    CHECK(!SSD1680_RefreshRegion(&hepd, 0, heights[k], PartialRefresh));
+    printf("%4u  %3u ms\n", heights[k], (unsigned)hepd.Busy_Duration);
+    CHECK(hepd.Busy_Duration == Stub.Busy_Time && hepd.Busy_Duration > previous);
+    previous = hepd.Busy_Duration;
+  }
+
+  CHECK(SSD1680_RefreshRegion(&hepd, 290, 32, PartialRefresh) == HAL_ERROR);
+  return 0;
+}
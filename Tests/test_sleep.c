@@ -0,0 +1,68 @@
+/*
+ * test_sleep.c
+ *
+ * Deep sleep: shadow registers invalidated and commands refused while asleep,
+ * warm resume restoring registers after mode 1 and full initialization after mode 2.
+ */
+
+#include "test.h"
+
+#define LOAD_LUT 0x10	/**< Update control 2 bit to load LUT, private to SSD1680.c */
+
+/**
+ * @brief Get update sequence of the last refresh
+ * @return Argument of update control 2 or 0 if not sent
+ */
+static uint8_t Sequence(void) {
+  for (uint32_t i = Stub.Log_Size; i >= 3; --i)
+    if (Stub.Log[i - 1] == SSD1680_MASTER_ACTIVATION && Stub.Log[i - 3] == SSD1680_UPDATE_CONTROL_2)
+      return Stub.Log[i - 2];
+  return 0;
+}
+
+int main(void) {
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  uint32_t start = HAL_GetTick();
+  CHECK(!SSD1680_Init(&hepd));
+  CHECK(!SSD1680_Wait(&hepd));
+  const uint32_t init = HAL_GetTick() - start;
+  CHECK(!SSD1680_Refresh(&hepd, FastFullRefresh));
+
+  Stub_ClearLog();
+  CHECK(!SSD1680_Sleep(&hepd, DeepSleep1));
+  Test_Dump("sleep 1");
+  CHECK(Stub.Log_Size >= 2 && Stub.Log[Stub.Log_Size - 2] == SSD1680_DEEP_SLEEP && Stub.Log[Stub.Log_Size - 1] == DeepSleep1);
+  // Registers are not trusted while asleep
+  CHECK(!hepd.Shadow.Valid);
+  Stub_ClearLog();
+  CHECK(SSD1680_Send(&hepd, SSD1680_NOP, NULL, 0) == HAL_ERROR);
+  CHECK(SSD1680_Refresh(&hepd, FastFullRefresh) == HAL_ERROR);
+  CHECK(Stub.Log_Size == 0);
+
+  // Hardware reset and registers replayed, nothing uploaded
+  Stub_ClearLog();
+  CHECK(!SSD1680_Resume(&hepd));
+  Test_Dump("warm resume");
+  const uint32_t warm = hepd.Resume_Duration;
+  CHECK(Stub.Log_Size && Stub.Log[Stub.Log_Size - 3] == SSD1680_WRITE_TEMP);
+  CHECK(hepd.Shadow.Valid);
+
+  // LUT is loaded by the refresh after wakeup only
+  Stub_ClearLog();
+  CHECK(!SSD1680_Refresh(&hepd, FastFullRefresh));
+  const uint8_t first = Sequence();
+  Stub_ClearLog();
+  CHECK(!SSD1680_Refresh(&hepd, FastFullRefresh));
+  const uint8_t second = Sequence();
+  printf("refresh after resume: 0x%02x, then 0x%02x\n", first, second);
+  CHECK((first & LOAD_LUT) && second == (first & ~LOAD_LUT));
+
+  CHECK(!SSD1680_Sleep(&hepd, DeepSleep2));
+  CHECK(!SSD1680_Resume(&hepd));
+  const uint32_t cold = hepd.Resume_Duration;
+  printf("cold init %u ms, warm resume %u ms, resume from mode 2 %u ms\n", (unsigned)init, (unsigned)warm, (unsigned)cold);
+  CHECK(warm < cold);
+  CHECK(!SSD1680_Resume(&hepd) && hepd.Resume_Duration == cold);
+  return 0;
+}
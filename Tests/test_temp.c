@@ -0,0 +1,92 @@
+/*
+ * test_temp.c
+ *
+ * Temperature reading in 1/16 °C and LUT caching: load bits stripped from update control 2 while cached temperature is fresh.
+ */
+
+#include "test.h"
+
+/**
+ * @brief Get update sequence of the last refresh
+ * @details Update control 2 is not sent again when unchanged, then the previous one is in effect.
+ * @return Argument of update control 2
+ */
+static uint8_t Sequence(void) {
+  static uint8_t sequence;
+  for (uint32_t i = Stub.Log_Size; i >= 3; --i)
+    if (Stub.Log[i - 1] == SSD1680_MASTER_ACTIVATION && Stub.Log[i - 3] == SSD1680_UPDATE_CONTROL_2) {
+      sequence = Stub.Log[i - 2];
+      break;
+    }
+  return sequence;
+}
+
+/**
+ * @brief Count temperature sensor reads in transmit log
+ */
+static uint8_t Reads(void) {
+  uint8_t reads = 0;
+  for (uint32_t i = 0; i < Stub.Log_Size; ++i)
+    reads += Stub.Log[i] == SSD1680_READ_TEMP;
+  return reads;
+}
+
+/**
+ * @brief Refresh and report what was sent
+ * @param[in] hepd: SSD1680 handle pointer
+ * @param[in] name: label
+ * @param[in] mode: refresh mode
+ * @return Update sequence
+ */
+static uint8_t Refresh(SSD1680_HandleTypeDef *hepd, const char *name, const enum SSD1680_RefreshMode mode) {
+  Stub_ClearLog();
+  CHECK(!SSD1680_Refresh(hepd, mode));
+  Test_Dump(name);
+  return Sequence();
+}
+
+static SSD1680_HandleTypeDef hepd;
+
+static void Falling(void) {
+  SSD1680_BUSY_EXTI_Callback(&hepd, STUB_BUSY_PIN);
+}
+
+int main(void) {
+  Test_Handle(&hepd, 2);
+  // Busy period ends exactly on the falling edge
+  hepd.BUSY_EXTI = 1;
+  Stub.BUSY_Callback = Falling;
+  CHECK(!SSD1680_Init(&hepd));
+
+  // Sensor register is 1/16 °C, MSB first
+  Stub.Temp = 21;
+  CHECK(SSD1680_ReadTemp(&hepd) == 21 * 16);
+  Stub.Temp = STUB_TEMP;
+
+  // Default: sensed and loaded on every refresh by the controller itself
+  CHECK(Refresh(&hepd, "default", FullRefresh) == 0xF7);
+  CHECK(Refresh(&hepd, "default again", FullRefresh) == 0xF7);
+  const uint32_t uncached = hepd.Busy_Duration;
+
+  hepd.Temp_Interval = 60000;
+  hepd.Temp_Delta = 3;
+  // Sensed once up front, LUT loaded for it
+  CHECK(Refresh(&hepd, "cached, first", FullRefresh) == 0xD7 && Reads() == 1);
+  CHECK(Refresh(&hepd, "cached", FullRefresh) == 0xC7 && Reads() == 0);
+  const uint32_t cached = hepd.Busy_Duration;
+  printf("full refresh: %u ms sensing and loading LUT, %u ms cached\n", (unsigned)uncached, (unsigned)cached);
+  CHECK(cached + STUB_TEMP_TIME + STUB_LUT_TIME == uncached);
+  CHECK(Refresh(&hepd, "cached, fast", FastFullRefresh) == 0xC7);
+  Stub.Tick += 60000;
+  Refresh(&hepd, "interval passed", FullRefresh);
+  CHECK(Reads() == 1);
+
+  // Supplied temperature goes to 0x1A, drift within Temp_Delta keeps the LUT
+  SSD1680_SetTemp(&hepd, 20);
+  CHECK(Refresh(&hepd, "supplied 20", FullRefresh) != 0xC7);
+  SSD1680_SetTemp(&hepd, 21);
+  CHECK(Refresh(&hepd, "supplied 21", FullRefresh) == 0xC7 && Reads() == 0);
+  SSD1680_SetTemp(&hepd, 25);
+  CHECK(Refresh(&hepd, "supplied 25", FullRefresh) != 0xC7);
+  return 0;
+}
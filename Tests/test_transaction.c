@@ -0,0 +1,72 @@
+/*
+ * test_transaction.c
+ *
+ * Transactions: commands sent in order under a single CS assertion, shadow registers checked when sent,
+ * per glyph bus cost of SSD1680_Text.
+ */
+
+#include "test.h"
+
+int main(void) {
+  SSD1680_HandleTypeDef hepd;
+  Test_Handle(&hepd, 2);
+  CHECK(!SSD1680_Init(&hepd));
+
+  // Two commands: one CS assertion, !DC low and high around each command byte
+  SSD1680_TransactionTypeDef tx;
+  SSD1680_TransactionBegin(&hepd, &tx);
+  const uint8_t range[] = { 0x00, 0x01 };
+  const uint8_t address[] = { 0x01 };
+  CHECK(!SSD1680_TransactionAdd(&tx, SSD1680_RAM_X_RANGE, range, sizeof(range)));
+  CHECK(!SSD1680_TransactionAdd(&tx, SSD1680_RAM_X, address, sizeof(address)));
+  Stub_ClearLog();
+  memset(&hepd.Stats, 0, sizeof(hepd.Stats));
+  CHECK(!SSD1680_TransactionCommit(&tx));
+  Test_Dump("transaction");
+  const uint8_t expected[] = { 0x44, 0x00, 0x01, 0x4E, 0x01 };
+  CHECK(Stub.Log_Size == sizeof(expected) && !memcmp(Stub.Log, expected, sizeof(expected)));
+  CHECK(hepd.Stats.Commands == 2 && hepd.Stats.Pin_Toggles == 2 + 2 * 2);
+  CHECK(Stub.X_End == 1 && Test_Released());
+
+  // Value queued earlier in the same transaction counts, not the one held before
+  const uint8_t narrow[] = { 0x00, 0x00 };
+  CHECK(!SSD1680_TransactionAdd(&tx, SSD1680_RAM_X_RANGE, narrow, sizeof(narrow)));
+  CHECK(!SSD1680_TransactionCommit(&tx));
+  Stub_ClearLog();
+  CHECK(!SSD1680_TransactionAdd(&tx, SSD1680_RAM_X_RANGE, range, sizeof(range)));
+  CHECK(!SSD1680_TransactionAdd(&tx, SSD1680_RAM_X_RANGE, narrow, sizeof(narrow)));
+  CHECK(!SSD1680_TransactionAdd(&tx, SSD1680_RAM_X_RANGE, narrow, sizeof(narrow)));
+  CHECK(!SSD1680_TransactionCommit(&tx));
+  Test_Dump("queued");
+  const uint8_t queued[] = { 0x44, 0x00, 0x01, 0x44, 0x00, 0x00 };
+  CHECK(Stub.Log_Size == sizeof(queued) && !memcmp(Stub.Log, queued, sizeof(queued)));
+  CHECK(Stub.X_End == 0);
+
+  // Nothing to send, nothing on the bus
+  Stub_ClearLog();
+  const uint32_t toggles = hepd.Stats.Pin_Toggles;
+  CHECK(!SSD1680_TransactionAdd(&tx, SSD1680_RAM_X_RANGE, narrow, sizeof(narrow)));
+  CHECK(!SSD1680_TransactionCommit(&tx));
+  CHECK(Stub.Log_Size == 0 && hepd.Stats.Pin_Toggles == toggles);
+
+  const char text[] = "Hello, world! The quick brown fox jumps over the lazy dog 0123456789";
+  const uint32_t glyphs = strlen(text);
+  memset(&hepd.Stats, 0, sizeof(hepd.Stats));
+  CHECK(!SSD1680_Text(&hepd, 0, 0, text, &cp866_8x8));
+  printf("per glyph: commands %.1f, SPI calls %.1f, SPI bytes %.1f, pin writes %.1f\n",
+      (double)hepd.Stats.Commands / glyphs, (double)hepd.Stats.SPI_Calls / glyphs,
+      (double)hepd.Stats.SPI_Bytes / glyphs, (double)hepd.Stats.Pin_Toggles / glyphs);
+  // Single CS assertion per glyph: 2 CS writes plus 2 !DC writes per command
+  CHECK(hepd.Stats.Pin_Toggles <= glyphs * (2 + 2 * 5));
+  CHECK(hepd.Stats.SPI_Calls <= glyphs * 10);
+  CHECK(Test_Released());
+
+  // Glyphs of a line share Y range, so the shadow elides its writes
+  const char lines[] = "The quick brown fox jumps over the lazy dog\nPack my box with five dozen liquor jugs!!";
+  memset(&hepd.Stats, 0, sizeof(hepd.Stats));
+  CHECK(!SSD1680_Text(&hepd, 0, 100, lines, &cp866_8x8));
+  printf("%u glyphs over 2 lines: %u commands sent, %u skipped by the shadow\n", (unsigned)(strlen(lines) - 1),
+      (unsigned)hepd.Stats.Commands, (unsigned)hepd.Stats.Commands_Skipped);
+  CHECK(hepd.Stats.Commands_Skipped >= strlen(lines) - 1 - 2);
+  return 0;
+}